@@ -0,0 +1,110 @@
+/**
+ * Filename:     BlockedBloomFilter.cpp
+ *
+ * Team:         Brandon Olmos (bolmos@ucsd.edu),
+ *               Daryl Nakamoto (dnakamot@ucsd.edu)
+ *
+ * Reference(s): cplusplus.com
+ *               https://github.com/aappleby/smhasher/wiki/MurmurHash3
+ *
+ * Description:  Cache-line blocked bloom filter. The first half of a single
+ *               MurmurHash3 call picks the 64 byte block, the second half
+ *               generates every bit position inside that block.
+ */
+
+#include "BlockedBloomFilter.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#define SEED 3
+
+using namespace std;
+
+/** Create a new blocked bloom filter with at least numBytes bytes.
+ *  numHashes is clamped to [1, MAX_HASHES]
+ */
+BlockedBloomFilter::BlockedBloomFilter(uint64_t numBytes,
+        unsigned int numHashes) : numHashes(numHashes)
+{
+    if(this->numHashes == 0) this->numHashes = 1;
+    if(this->numHashes > MAX_HASHES) this->numHashes = MAX_HASHES;
+
+    // round up to whole blocks
+    numBlocks = (numBytes + BLOCK_BYTES - 1) / BLOCK_BYTES;
+    if(numBlocks == 0) numBlocks = 1;
+
+    void* mem = nullptr;
+    if(posix_memalign(&mem, BLOCK_BYTES, numBlocks * BLOCK_BYTES))
+        throw bad_alloc();
+
+    table = (uint64_t*)mem;
+
+    // set all bits in table to 0
+    memset(table, 0, numBlocks * BLOCK_BYTES);
+}
+
+/** Create a blocked bloom filter sized to hold numItems at roughly false
+ *  positive rate fpRate
+ */
+BlockedBloomFilter* BlockedBloomFilter::forRate(uint64_t numItems,
+        double fpRate) {
+
+    uint64_t numBytes = BloomFilter::optimalNumBytes(numItems, fpRate);
+
+    return new BlockedBloomFilter(numBytes,
+            BloomFilter::optimalNumHashes(numItems, numBytes));
+}
+
+/** Destructor for the blocked bloom filter */
+BlockedBloomFilter::~BlockedBloomFilter()
+{
+    free(table);
+}
+
+/** hash str, return its block and fill bits with positions in the block */
+uint64_t* BlockedBloomFilter::getBlock(const char* str, size_t len,
+        unsigned int* bits) {
+
+    // hold the hash value returned from hash function
+    uint64_t output[2];
+
+    MurmurHash3_x64_128(str, len, SEED, output);
+
+    // double hash inside the block; an odd stride visits distinct bits
+    uint32_t h1 = output[1];
+    uint32_t h2 = (output[1] >> 32) | 1;
+
+    for(unsigned int i = 0; i < numHashes; ++i)
+        bits[i] = (h1 + i * h2) % BLOCK_BITS;
+
+    return table + (output[0] % numBlocks) * BLOCK_WORDS;
+}
+
+/** Insert an item of len bytes into the bloom filter, hashed in place */
+void BlockedBloomFilter::insert(const char* item, size_t len)
+{
+    unsigned int bits[numHashes];
+
+    uint64_t* block = getBlock(item, len, bits);
+
+    // set the bits, all within one cache line
+    for(unsigned int i = 0; i < numHashes; ++i)
+        block[bits[i] / 64] |= (uint64_t)1 << (bits[i] % 64);
+}
+
+/** Determine whether an item of len bytes is in the bloom filter */
+bool BlockedBloomFilter::find(const char* item, size_t len)
+{
+    unsigned int bits[numHashes];
+
+    uint64_t* block = getBlock(item, len, bits);
+
+    // check if item was inserted into table (make prediction)
+    for(unsigned int i = 0; i < numHashes; ++i) {
+        if(!(block[bits[i] / 64] & ((uint64_t)1 << (bits[i] % 64))))
+            return false;
+    }
+
+    return true;
+}
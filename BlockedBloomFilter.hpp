@@ -0,0 +1,87 @@
+/**
+ * Filename:     BlockedBloomFilter.hpp
+ *
+ * Team:         Brandon Olmos (bolmos@ucsd.edu),
+ *               Daryl Nakamoto (dnakamot@ucsd.edu)
+ *
+ * Reference(s): cplusplus.com
+ *               https://github.com/aappleby/smhasher/wiki/MurmurHash3
+ *
+ * Description:  Cache-line blocked bloom filter. Every item lives in a single
+ *               64 byte block of the table, so a lookup costs at most one
+ *               cache miss no matter how many bits are checked.
+ */
+
+#ifndef BLOCKED_BLOOM_FILTER_HPP
+#define BLOCKED_BLOOM_FILTER_HPP
+
+#include <string>
+#include <stdint.h>
+#include "BloomFilter.hpp"
+
+#define BLOCK_BYTES 64                // one cache line
+#define BLOCK_BITS (BLOCK_BYTES * 8)
+#define BLOCK_WORDS (BLOCK_BYTES / 8) // 64-bit words per block
+
+using namespace std;
+
+/**
+ * Bloom filter whose table is split into cache line sized blocks. One hash
+ * selects the block, and all bits of the item are set or tested inside it.
+ * Slightly higher false positive rate than BloomFilter for the same size.
+ */
+class BlockedBloomFilter {
+
+private:
+
+    // table of 64-bit words, aligned so each block is one cache line
+    uint64_t* table;
+    uint64_t numBlocks;
+
+    // number of bits set per item
+    unsigned int numHashes;
+
+    /** hash str, return its block and fill bits with positions in the block */
+    uint64_t* getBlock(const char* str, size_t len, unsigned int* bits);
+
+    // no copies, the table is owned
+    BlockedBloomFilter(const BlockedBloomFilter&);
+    BlockedBloomFilter& operator=(const BlockedBloomFilter&);
+
+public:
+
+    /** Destructor for the blocked bloom filter */
+    ~BlockedBloomFilter();
+
+    /** Create a new blocked bloom filter with at least numBytes bytes.
+     *  numHashes is clamped to [1, MAX_HASHES].
+     */
+    BlockedBloomFilter(uint64_t numBytes,
+            unsigned int numHashes = DEFAULT_HASHES);
+
+    /** Create a blocked bloom filter sized to hold numItems at roughly false
+     *  positive rate fpRate. A factory, like BloomFilter::forRate(), so
+     *  (numBytes, 3) cannot be taken for a rate. The caller owns the
+     *  returned filter.
+     */
+    static BlockedBloomFilter* forRate(uint64_t numItems, double fpRate);
+
+    /** Insert an item of len bytes into the bloom filter, hashed in place */
+    void insert(const char* item, size_t len);
+
+    /** Determine whether an item of len bytes is in the bloom filter */
+    bool find(const char* item, size_t len);
+
+    /** Insert an item into the bloom filter */
+    void insert(const std::string& item) { insert(item.data(), item.size()); }
+
+    /** Determine whether an item is in the bloom filter */
+    bool find(const std::string& item) { return find(item.data(), item.size()); }
+
+    /** Size of the table in bytes */
+    uint64_t getNumBytes() const { return numBlocks * BLOCK_BYTES; }
+
+    /** Number of bits set per item */
+    unsigned int getNumHashes() const { return numHashes; }
+};
+#endif // BLOCKED_BLOOM_FILTER_HPP
@@ -17,59 +17,345 @@
 #include <iostream>
 #include <cmath>
 #include <cstring>
-
+#include <thread>
+#include <vector>
+#include <new>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAVE_AVX2_KERNEL
+#endif
 
 #define SEED1 3
-#define SEED2 5
-#define SEED3 7
+#define SEED_STEP 2 // seeded probes use SEED1, SEED1 + 2, SEED1 + 4, ...
+
+#define FILE_VERSION 2 // 2: fastrange positions, table padded to 64-bit words
+#define HEADER_BYTES 64       // table starts on a cache line of the file
 
 using namespace std;
 
+/** Header of a saved filter, written in host byte order */
+struct FilterHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t mode;      // ProbeMode
+    uint32_t numHashes;
+    uint32_t seed;      // SEED1
+    uint32_t seedStep;  // SEED_STEP
+    uint32_t hashId;    // Hash::ID
+    uint64_t tableSize; // in bits
+    uint64_t numItems;
+    unsigned char padding[HEADER_BYTES - 48];
+};
+
+static_assert(sizeof(FilterHeader) == HEADER_BYTES, "filter header size");
+
 /** Create a new bloom filter with the size in bytes */
-BloomFilter::BloomFilter(uint64_t numBytes)
+template<class Hash>
+BasicBloomFilter<Hash>::BasicBloomFilter(uint64_t numBytes, ProbeMode mode,
+        unsigned int numHashes, TableMemory memory) : numHashes(numHashes),
+    mode(mode), numItems(0), mapping(nullptr), mappingSize(0),
+    memory(memory), hugePages(false)
 {
-    table = new unsigned char[numBytes];
+    // never build an empty table, the probes take positions mod its size
+    if(numBytes == 0) numBytes = 1;
+    if(this->numHashes == 0) this->numHashes = 1;
+    if(this->numHashes > MAX_HASHES) this->numHashes = MAX_HASHES;
+
     tableSize = numBytes * 8; // 8 bits per Byte
+    allocateTable();
+}
+
+/** Create a bloom filter sized to hold numItems at false positive rate fpRate,
+ *  using the optimal number of hashes for that size
+ */
+template<class Hash>
+BasicBloomFilter<Hash>* BasicBloomFilter<Hash>::forRate(uint64_t numItems,
+        double fpRate, ProbeMode mode, TableMemory memory) {
+
+    uint64_t numBytes = optimalNumBytes(numItems, fpRate);
+
+    return new BasicBloomFilter(numBytes, mode,
+            optimalNumHashes(numItems, numBytes), memory);
+}
+
+/** Map size bytes of zeroed anonymous memory starting on a huge page
+ *  boundary, so transparent huge pages can back all of it. Returns
+ *  MAP_FAILED if the mapping failed.
+ */
+static void* mapHugeAligned(uint64_t size) {
+
+    // over-map by a huge page and trim both ends to the aligned range
+    uint64_t span = size + HUGE_PAGE_BYTES;
+    void* mem = mmap(nullptr, span, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(mem == MAP_FAILED) return MAP_FAILED;
+
+    uintptr_t start = (uintptr_t)mem;
+    uintptr_t aligned = (start + HUGE_PAGE_BYTES - 1) /
+                        HUGE_PAGE_BYTES * HUGE_PAGE_BYTES;
+
+    if(aligned > start)
+        munmap(mem, aligned - start);
+    if(start + span > aligned + size)
+        munmap((void*)(aligned + size), start + span - (aligned + size));
+
+    return (void*)aligned;
+}
+
+/** allocate a zeroed table of getNumWords() words as memory asks. Huge page
+ *  tables try explicit huge pages, then transparent ones, then the heap.
+ */
+template<class Hash>
+void BasicBloomFilter<Hash>::allocateTable() {
+
+    uint64_t numBytes = getNumWords() * sizeof(uint64_t);
+
+    if(memory == HUGE_PAGE_TABLE) {
+        // whole huge pages, anonymous mappings start zeroed
+        uint64_t size = (numBytes + HUGE_PAGE_BYTES - 1) / HUGE_PAGE_BYTES
+                        * HUGE_PAGE_BYTES;
+        void* mem = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+        // explicit huge pages only exist if the admin reserved some
+        mem = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        hugePages = mem != MAP_FAILED;
+#endif
+
+        if(mem == MAP_FAILED) {
+            mem = mapHugeAligned(size);
+
+#ifdef MADV_HUGEPAGE
+            // fails if transparent huge pages are disabled, the mapping
+            // still works with normal pages
+            hugePages = mem != MAP_FAILED &&
+                        madvise(mem, size, MADV_HUGEPAGE) == 0;
+#endif
+        }
+
+        if(mem != MAP_FAILED) {
+            table = (uint64_t*)mem;
+            mapping = mem;
+            mappingSize = size;
+            return;
+        }
+    }
+
+    void* mem = nullptr;
+    if(posix_memalign(&mem, TABLE_ALIGN, numBytes))
+        throw bad_alloc();
+
+    table = (uint64_t*)mem;
 
     // set all bits in table to 0
     memset(table, 0, numBytes);
 }
 
+/** Bytes needed to hold numItems at false positive rate fpRate.
+ *  m = -n ln(p) / ln(2)^2 bits
+ */
+template<class Hash>
+uint64_t BasicBloomFilter<Hash>::optimalNumBytes(uint64_t numItems,
+        double fpRate) {
+
+    // clamp rates that have no sensible table size
+    if(fpRate <= 0) fpRate = 1e-12;
+    if(fpRate >= 1) return 1;
+
+    double numBits = -(double)numItems * log(fpRate) / (M_LN2 * M_LN2);
+    uint64_t numBytes = ceil(numBits / 8);
+
+    return numBytes ? numBytes : 1;
+}
+
+/** Number of hashes minimizing false positives for numItems in numBytes.
+ *  k = (m / n) ln(2)
+ */
+template<class Hash>
+unsigned int BasicBloomFilter<Hash>::optimalNumHashes(uint64_t numItems,
+        uint64_t numBytes) {
+
+    if(numItems == 0) return 1;
+
+    double numHashes = round(8.0 * numBytes / numItems * M_LN2);
+
+    if(numHashes > MAX_HASHES) return MAX_HASHES;
+
+    return numHashes < 1 ? 1 : (unsigned int)numHashes;
+}
+
+/** Expected false positive rate once numItems have been inserted.
+ *  p = (1 - e^(-kn/m))^k
+ */
+template<class Hash>
+double BasicBloomFilter<Hash>::expectedFPR(uint64_t numItems) const {
+    return pow(1 - exp(-(double)numHashes * numItems / tableSize), numHashes);
+}
+
+/** Fraction of the table's bits that are set */
+template<class Hash>
+double BasicBloomFilter<Hash>::fillRatio() const {
+
+    uint64_t numSet = 0;
+
+    for(uint64_t i = 0; i < getNumWords(); ++i)
+        numSet += __builtin_popcountll(table[i]);
+
+    return (double)numSet / tableSize;
+}
+
+/** False positive rate estimated from the table itself: a lookup of an
+ *  absent item passes if all numHashes of its bits happen to be set.
+ *  p = fill^k
+ */
+template<class Hash>
+double BasicBloomFilter<Hash>::estimatedFPR() const {
+    return pow(fillRatio(), numHashes);
+}
+
+/** Write the filter's geometry, fill and estimated false positive rate as a
+ *  JSON object, with operation counts and latencies if built with
+ *  FILTER_STATS
+ */
+template<class Hash>
+void BasicBloomFilter<Hash>::dumpStats(ostream& out) const {
+
+    out << "{\"hash\":\"" << Hash::name() << "\""
+        << ",\"items\":" << numItems
+        << ",\"bytes\":" << getNumBytes()
+        << ",\"hashes\":" << numHashes
+        << ",\"huge_pages\":" << (hugePages ? "true" : "false")
+        << ",\"fill_ratio\":" << fillRatio()
+        << ",\"estimated_fpr\":" << estimatedFPR()
+        << ",\"expected_fpr\":" << expectedFPR(numItems);
+
+#ifdef FILTER_STATS
+    out << ",\"inserts\":";
+    insertStats.dump(out);
+    out << ",\"finds\":";
+    findStats.dump(out);
+#endif
+
+    out << "}";
+}
+
 /** Destructor for the bloom filter */
-BloomFilter::~BloomFilter()
+template<class Hash>
+BasicBloomFilter<Hash>::~BasicBloomFilter()
 {
-    delete table;
+    if(mapping)
+        munmap(mapping, mappingSize);
+    else
+        free(table);
 }
 
-/** insert in pos position of hash table */
-void BloomFilter::setBit(unsigned int pos) {
+/** Write the filter to fileName in the versioned binary format.
+ *  Returns false if the file could not be written.
+ */
+template<class Hash>
+bool BasicBloomFilter<Hash>::save(string fileName) const {
+
+    FilterHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BLOOM_FILE_MAGIC, sizeof(header.magic));
+    header.version = FILE_VERSION;
+    header.mode = mode;
+    header.numHashes = numHashes;
+    header.seed = SEED1;
+    header.seedStep = SEED_STEP;
+    header.hashId = Hash::ID;
+    header.tableSize = tableSize;
+    header.numItems = numItems;
+
+    ofstream file(fileName, ios::binary | ios::trunc);
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)table, getNumWords() * sizeof(uint64_t));
+
+    return file.good();
+}
+
+/** Map a filter written by save() without copying its table. Returns nullptr
+ *  if the file is missing, truncated or incompatible.
+ */
+template<class Hash>
+BasicBloomFilter<Hash>* BasicBloomFilter<Hash>::load(string fileName) {
 
-    unsigned index = pos / 8;     // select char
-    unsigned bitInd = pos % 8;    // select position in char
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if(fd < 0) return nullptr;
 
-    // go to the pos bit in table
-    bitInd = pow(2, bitInd);
+    struct stat info;
+    if(fstat(fd, &info) < 0 || (uint64_t)info.st_size < HEADER_BYTES) {
+        close(fd);
+        return nullptr;
+    }
+
+    // private writable mapping: lookups read the file pages in place, and an
+    // insert into a loaded filter copies only the page it touches
+    uint64_t size = info.st_size;
+    void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if(mem == MAP_FAILED) return nullptr;
+
+    // reject other formats, and filters hashed differently from this build
+    const FilterHeader* header = (const FilterHeader*)mem;
+    if(memcmp(header->magic, BLOOM_FILE_MAGIC, sizeof(header->magic)) != 0 ||
+            header->version != FILE_VERSION ||
+            header->mode > DOUBLE_HASH || header->numHashes == 0 ||
+            header->numHashes > MAX_HASHES ||
+            header->seed != SEED1 || header->seedStep != SEED_STEP ||
+            header->hashId != Hash::ID ||
+            header->tableSize == 0 || header->tableSize % 8 != 0 ||
+            (header->tableSize + 63) / 64 * 8 > size - HEADER_BYTES) {
+        munmap(mem, size);
+        return nullptr;
+    }
+
+    BasicBloomFilter* filter = new BasicBloomFilter();
+    filter->table = (uint64_t*)((char*)mem + HEADER_BYTES);
+    filter->tableSize = header->tableSize;
+    filter->numHashes = header->numHashes;
+    filter->mode = (ProbeMode)header->mode;
+    filter->numItems = header->numItems;
+    filter->mapping = mem;
+    filter->mappingSize = size;
+
+    return filter;
+}
+
+/** insert in pos position of hash table */
+template<class Hash>
+void BasicBloomFilter<Hash>::setBit(uint64_t pos) {
+
+    uint64_t index = pos >> 6;  // select word
+    unsigned bitInd = pos & 63; // select position in word
 
     // set the pos bit
-    table[index] = table[index] | bitInd;
+    table[index] |= (uint64_t)1 << bitInd;
 }
 
 /** check if pos position in hash table is filled */
-bool BloomFilter::hasBit(unsigned int pos) {
-
-    unsigned int index = pos / 8;    // select char
-    unsigned int bitInd = pos % 8;   // select position in char
+template<class Hash>
+bool BasicBloomFilter<Hash>::hasBit(uint64_t pos) {
 
-    // go to the pos bit
-    bitInd = pow(2, bitInd);
+    uint64_t index = pos >> 6;  // select word
+    unsigned bitInd = pos & 63; // select position in word
 
     // return true if the bit has been set, false if not
-    return table[index] & bitInd;
+    return (table[index] >> bitInd) & 1;
 }
 
 /** train bloom filter */
-void BloomFilter::trainFilter(ifstream& file, string badUrls,
-        BloomFilter& filter) {
+template<class Hash>
+void BasicBloomFilter<Hash>::trainFilter(ifstream& file, string badUrls,
+        BasicBloomFilter& filter) {
 
     string url;
 
@@ -83,93 +369,348 @@ void BloomFilter::trainFilter(ifstream& file, string badUrls,
     file.seekg(0, ios::beg);
 }
 
-/** read file of urls and write good urls to an output file */
-void BloomFilter::processURLs(ifstream& file, string goodUrls, ofstream& output,
-        string outputFile, double& numOutput, double& numUrls) {
+/** read the lines starting in byte range [start, end) of badUrls into filter.
+ *  A line belongs to the range its first byte falls in.
+ */
+template<class Filter>
+static void trainRange(string badUrls, uint64_t start, uint64_t end,
+        Filter* filter) {
 
+    ifstream file(badUrls, ios::binary);
     string url;
-    bool isBadURL;
+    uint64_t pos = start;
+
+    // skip the line already started before start; it belongs to the range
+    // before. If the byte before start is a newline this reads an empty line.
+    if(start > 0) {
+        file.seekg(start - 1);
+        getline(file, url);
+        pos = start - 1 + url.size() + 1;
+    }
 
-    // read the file and write predicted good urls to output file, outputFile
-    file.open(goodUrls);
-    output.open(outputFile);
-    while(getline(file, url)) {
-        isBadURL = find(url);
+    // insert in batches so the urls can share the four-lane hash
+    vector<string> batch;
 
-        if(!isBadURL) {
-            output << url << endl;
-            ++numOutput;
-        }
+    while(pos < end && getline(file, url)) {
+        pos += url.size() + 1;
+        batch.push_back(url);
 
-        ++numUrls;
+        if(batch.size() == BATCH_SIZE) {
+            filter->insertBatch(batch.data(), batch.size());
+            batch.clear();
+        }
     }
 
-    // close and clear the buffers for both file so they can be reused later
+    filter->insertBatch(batch.data(), batch.size());
+}
+
+/** train bloom filter with numThreads threads, each building a partial filter
+ *  from one line-aligned byte range of badUrls, then merge them
+ */
+template<class Hash>
+void BasicBloomFilter<Hash>::trainFilterParallel(string badUrls,
+        unsigned int numThreads)
+{
+    if(numThreads == 0) numThreads = 1;
+
+    ifstream file(badUrls, ios::binary | ios::ate);
+    uint64_t fileSize = file ? (uint64_t)file.tellg() : 0;
     file.close();
-    file.seekg(0, ios::beg);
-    output.close();
+
+    uint64_t perThread = (fileSize + numThreads - 1) / numThreads;
+    vector<BasicBloomFilter*> partials;
+    vector<thread> workers;
+
+    // the first range is trained into this filter, the rest into partials
+    for(unsigned int t = 0; t < numThreads; ++t) {
+        uint64_t start = t * perThread;
+        uint64_t end = start + perThread < fileSize ? start + perThread
+                                                    : fileSize;
+
+        if(start >= end) break;
+
+        BasicBloomFilter* filter = this;
+        if(t > 0) {
+            filter = new BasicBloomFilter(getNumBytes(), mode, numHashes,
+                                          memory);
+            partials.push_back(filter);
+        }
+
+        workers.push_back(thread(trainRange<BasicBloomFilter>, badUrls, start,
+                                 end, filter));
+    }
+
+    for(auto& worker : workers)
+        worker.join();
+
+    for(BasicBloomFilter* partial : partials) {
+        unionWith(*partial);
+        delete partial;
+    }
 }
 
-/** Insert an item into the bloom filter */
-void BloomFilter::insert(string item)
+#ifdef HAVE_AVX2_KERNEL
+/** dst |= src for numWords words, four words at a time */
+__attribute__((target("avx2")))
+static void orTableAVX2(uint64_t* dst, const uint64_t* src,
+        uint64_t numWords) {
+
+    uint64_t i = 0;
+
+    for(; i + 4 <= numWords; i += 4) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(dst + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(src + i));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_or_si256(a, b));
+    }
+
+    for(; i < numWords; ++i)
+        dst[i] |= src[i];
+}
+#endif // HAVE_AVX2_KERNEL
+
+/** dst |= src for numWords words */
+static void orTableScalar(uint64_t* dst, const uint64_t* src,
+        uint64_t numWords) {
+
+    for(uint64_t i = 0; i < numWords; ++i)
+        dst[i] |= src[i];
+}
+
+/** Add every item of other to this filter by OR-ing the tables.
+ *  Returns false if the filters differ in size, hashes or probe mode.
+ */
+template<class Hash>
+bool BasicBloomFilter<Hash>::unionWith(const BasicBloomFilter& other)
 {
+    if(tableSize != other.tableSize || numHashes != other.numHashes ||
+            mode != other.mode)
+        return false;
+
+    numItems += other.numItems;
+
+#ifdef HAVE_AVX2_KERNEL
+    if(__builtin_cpu_supports("avx2")) {
+        orTableAVX2(table, other.table, getNumWords());
+        return true;
+    }
+#endif
+
+    orTableScalar(table, other.table, getNumWords());
+    return true;
+}
+
+/** hash str and fill pos with the positions of its bits in the table */
+template<class Hash>
+void BasicBloomFilter<Hash>::getPositions(const char* str, size_t len,
+        uint64_t* pos) {
+    hashPositions(str, len, mode, numHashes, tableSize, pos);
+}
+
+/** hash str and fill pos with numHashes bit positions in a table of
+ *  tableSize bits
+ */
+template<class Hash>
+void BasicBloomFilter<Hash>::hashPositions(const char* str, size_t len,
+        ProbeMode mode, unsigned int numHashes, uint64_t tableSize,
+        uint64_t* pos) {
+
     // hold the hash value returned from hash function
     uint64_t output[2];
 
-    // hold positions returned from hash functions
-    uint64_t pos1;
-    uint64_t pos2;
-    uint64_t pos3;
+    // original scheme: a full hash per probe, keeping only output[1]
+    if(mode == SEEDED_PROBES) {
+        for(unsigned int i = 0; i < numHashes; ++i) {
+            Hash::hash(str, len, SEED1 + i * SEED_STEP, output);
+            pos[i] = fastRange(output[1], tableSize);
+        }
 
-    // get url from input (requirement of Murmurhash3; has to be this way)
-    char str[item.size() + 1];
-    strcpy(str, item.c_str());
+        return;
+    }
 
+    /** Kirsch-Mitzenmacher double hashing: both 64-bit halves of a single
+     *  hash give the base and the stride, probe i is h1 + i*h2
+     */
+    Hash::hash(str, len, SEED1, output);
 
-    /** Get 3 hash values to set bits for item */
-    MurmurHash3_x64_128(&str, sizeof(str), uint64_t(SEED1), output);
-    pos1 = output[1] % tableSize;
+    doubleHashPositions(output, numHashes, tableSize, pos);
+}
 
-    MurmurHash3_x64_128(&str, sizeof(str), uint64_t(SEED2), output);
-    pos2 = output[1] % tableSize;
+/** fill pos with the numHashes double hashing positions of output */
+template<class Hash>
+void BasicBloomFilter<Hash>::doubleHashPositions(const uint64_t* output,
+        unsigned int numHashes, uint64_t tableSize, uint64_t* pos) {
 
-    MurmurHash3_x64_128(&str, sizeof(str), uint64_t(SEED3), output);
-    pos3 = output[1] % tableSize;
+    uint64_t h1 = output[0];
+    uint64_t h2 = output[1];
 
-    // set the bits
-    setBit(pos1);
-    setBit(pos2);
-    setBit(pos3);
+    for(unsigned int i = 0; i < numHashes; ++i)
+        pos[i] = fastRange(h1 + i * h2, tableSize);
 }
 
-/** Determine whether an item is in the bloom filter */
-bool BloomFilter::find(string item)
+/** hash count keys and fill pos with numHashes positions per key. Double
+ *  hashing needs one hash per key, so groups of HASH_LANES keys share one
+ *  call to the policy's hash4; seeded probes and leftovers go one by one.
+ */
+template<class Hash>
+void BasicBloomFilter<Hash>::getBatchPositions(const char* const* keys,
+        const size_t* lens, size_t count, uint64_t* pos) {
+
+    size_t i = 0;
+
+    if(mode == DOUBLE_HASH) {
+        uint64_t output[HASH_LANES * 2];
+
+        for(; i + HASH_LANES <= count; i += HASH_LANES) {
+            Hash::hash4(keys + i, lens + i, SEED1, output);
+
+            for(size_t j = 0; j < HASH_LANES; ++j)
+                doubleHashPositions(output + j * 2, numHashes, tableSize,
+                                    pos + (i + j) * numHashes);
+        }
+    }
+
+    for(; i < count; ++i)
+        getPositions(keys[i], lens[i], pos + i * numHashes);
+}
+
+/** Insert an item of len bytes into the bloom filter, hashed in place */
+template<class Hash>
+void BasicBloomFilter<Hash>::insert(const char* item, size_t len)
 {
-    // hold the hash value returned from hash function
-    uint64_t output[2];
+    STATS_OP(insertStats);
 
     // hold positions returned from hash functions
-    uint64_t pos1 = 0;
-    uint64_t pos2 = 0;
-    uint64_t pos3 = 0;
+    uint64_t pos[numHashes];
 
-    char str[item.size() + 1];
-    strcpy(str, item.c_str());
+    // get hash values to set bits for item
+    getPositions(item, len, pos);
 
+    // set the bits
+    for(unsigned int i = 0; i < numHashes; ++i)
+        setBit(pos[i]);
 
-    /** Get the 3 hash values used to set the bits for item */
-    MurmurHash3_x64_128(&str, sizeof(str), uint64_t(SEED1), output);
-    pos1 = output[1] % tableSize;
+    ++numItems;
+}
+
+/** Determine whether an item of len bytes is in the bloom filter */
+template<class Hash>
+bool BasicBloomFilter<Hash>::find(const char* item, size_t len)
+{
+    STATS_OP(findStats);
 
-    MurmurHash3_x64_128(&str, sizeof(str), uint64_t(SEED2), output);
-    pos2 = output[1] % tableSize;
+    // hold positions returned from hash functions
+    uint64_t pos[numHashes];
 
-    MurmurHash3_x64_128(&str, sizeof(str), uint64_t(SEED3), output);
-    pos3 = output[1] % tableSize;
+    // get the hash values used to set the bits for item
+    getPositions(item, len, pos);
 
     // check if item was inserted into table (make prediction)
-    if(hasBit(pos1) && hasBit(pos2) && hasBit(pos3))
-        return true;
+    for(unsigned int i = 0; i < numHashes; ++i) {
+        if(!hasBit(pos[i]))
+            return false;
+    }
+
+    STATS_HITS(findStats, 1);
+    return true;
+}
+
+/** Determine for each of the n keys whether it is in the bloom filter,
+ *  storing the answers in out. Hashes a batch of keys and prefetches their
+ *  table bytes before testing any of them, so the cache misses of a batch
+ *  overlap instead of being paid one key at a time.
+ */
+template<class Hash>
+void BasicBloomFilter<Hash>::findBatch(const char* const* keys,
+        const size_t* lens, size_t n, bool* out)
+{
+    STATS_OPS(findStats, n);
+
+    // positions of every key in the batch, numHashes per key
+    uint64_t pos[BATCH_SIZE * numHashes];
+
+    for(size_t start = 0; start < n; start += BATCH_SIZE) {
+        size_t count = n - start < BATCH_SIZE ? n - start : BATCH_SIZE;
+
+        // hash the batch and start loading the words it will read
+        getBatchPositions(keys + start, lens + start, count, pos);
+
+        for(size_t i = 0; i < count * numHashes; ++i)
+            __builtin_prefetch(table + (pos[i] >> 6));
+
+        // resolve the membership tests, the bytes should be cached by now
+        for(size_t i = 0; i < count; ++i) {
+            uint64_t* keyPos = pos + i * numHashes;
+            bool found = true;
+
+            for(unsigned int j = 0; j < numHashes && found; ++j)
+                found = hasBit(keyPos[j]);
+
+            out[start + i] = found;
+            STATS_HITS(findStats, found);
+        }
+    }
+}
+
+/** Determine for each of the n strings whether it is in the bloom filter */
+template<class Hash>
+void BasicBloomFilter<Hash>::findBatch(const string* keys, size_t n, bool* out)
+{
+    const char* strs[BATCH_SIZE];
+    size_t lens[BATCH_SIZE];
+
+    for(size_t start = 0; start < n; start += BATCH_SIZE) {
+        size_t count = n - start < BATCH_SIZE ? n - start : BATCH_SIZE;
+
+        for(size_t i = 0; i < count; ++i) {
+            strs[i] = keys[start + i].data();
+            lens[i] = keys[start + i].size();
+        }
+
+        findBatch(strs, lens, count, out + start);
+    }
+}
+
+/** Insert the n keys of lens[i] bytes into the bloom filter */
+template<class Hash>
+void BasicBloomFilter<Hash>::insertBatch(const char* const* keys,
+        const size_t* lens, size_t n)
+{
+    STATS_OPS(insertStats, n);
+
+    uint64_t pos[BATCH_SIZE * numHashes];
+
+    for(size_t start = 0; start < n; start += BATCH_SIZE) {
+        size_t count = n - start < BATCH_SIZE ? n - start : BATCH_SIZE;
+
+        getBatchPositions(keys + start, lens + start, count, pos);
+
+        for(size_t i = 0; i < count * numHashes; ++i)
+            setBit(pos[i]);
+    }
+
+    numItems += n;
+}
+
+/** Insert the n strings into the bloom filter */
+template<class Hash>
+void BasicBloomFilter<Hash>::insertBatch(const string* keys, size_t n)
+{
+    const char* strs[BATCH_SIZE];
+    size_t lens[BATCH_SIZE];
+
+    for(size_t start = 0; start < n; start += BATCH_SIZE) {
+        size_t count = n - start < BATCH_SIZE ? n - start : BATCH_SIZE;
+
+        for(size_t i = 0; i < count; ++i) {
+            strs[i] = keys[start + i].data();
+            lens[i] = keys[start + i].size();
+        }
+
+        insertBatch(strs, lens, count);
+    }
+}
 
-    return false;
-}
\ No newline at end of file
+// the hash policies filters can be built with
+template class BasicBloomFilter<Murmur3x64Hash>;
+template class BasicBloomFilter<Murmur3x86Hash>;
+template class BasicBloomFilter<Wy64Hash>;
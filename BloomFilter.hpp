@@ -16,50 +16,232 @@
 #include <fstream>
 #include <string>
 #include <stdint.h>
-#include "MurmurHash3.h" // See +++ above
+#include <cstddef>
+#include "MembershipFilter.hpp"
+#include "HashPolicy.hpp" // See +++ above
+#include "FilterStats.hpp"
+
+#define DEFAULT_HASHES 3            // probes when not sized from a rate
+#define MAX_HASHES 64               // probe positions are kept on the stack
+#define BLOOM_FILE_MAGIC "BLMFILTR" // first 8 bytes of a saved bloom filter
+#define TABLE_ALIGN 64              // tables start on a cache line
+#define HUGE_PAGE_BYTES (2 << 20)   // x86-64 huge page size
 
 using namespace std;
 
+/** How the bit positions of an item are derived from its hash */
+enum ProbeMode {
+    SEEDED_PROBES, // one hash call per probe, each with its own seed
+    DOUBLE_HASH    // one hash call, probe i is h1 + i*h2
+};
+
+/** Where the table of a new filter is allocated */
+enum TableMemory {
+    HEAP_TABLE,     // cache line aligned heap memory
+    HUGE_PAGE_TABLE // huge page backed mapping, heap memory if unavailable
+};
+
 /**
  * The class for bloom filter that provides memory efficient check
  * of whether an item has been inserted before. Small amount of 
  * false positives is possible but there will be no false negatives.
+ * Hash is the hash policy (see HashPolicy.hpp) probe positions come from.
  */
-class BloomFilter {
+template<class Hash>
+class BasicBloomFilter : public MembershipFilter {
 
 private:
 
-    // create has table using char array. The bits are the spots
-    unsigned char* table;
-    uint64_t tableSize;
+    // create has table using 64-bit words. The bits are the spots
+    uint64_t* table;
+    uint64_t tableSize; // in bits
+
+    // number of bits set per item
+    unsigned int numHashes;
+
+    // how probe positions are generated for an item
+    ProbeMode mode;
+
+    // number of items inserted, duplicates included
+    uint64_t numItems;
+
+    // mapping holding the table when loaded with load() or allocated on huge
+    // pages, else nullptr
+    void* mapping;
+    uint64_t mappingSize;
+
+    // requested table memory, and whether huge pages were actually granted
+    TableMemory memory;
+    bool hugePages;
+
+#ifdef FILTER_STATS
+    // operation counts and sampled latencies
+    OpStats insertStats;
+    OpStats findStats;
+#endif
+
+    /** Create an empty filter for load() to fill in */
+    BasicBloomFilter() : table(nullptr), tableSize(0), numHashes(0),
+        mode(DOUBLE_HASH), numItems(0), mapping(nullptr), mappingSize(0),
+        memory(HEAP_TABLE), hugePages(false) {}
 
+    /** allocate a zeroed table of getNumWords() words as memory asks */
+    void allocateTable();
+
+    /** hash str and fill pos with the positions of its bits in the table */
+    void getPositions(const char* str, size_t len, uint64_t* pos);
+
+    /** hash count keys and fill pos with numHashes positions per key,
+     *  hashing HASH_LANES keys at a time in double hashing mode
+     */
+    void getBatchPositions(const char* const* keys, const size_t* lens,
+            size_t count, uint64_t* pos);
+
+    /** number of 64-bit words holding the table */
+    uint64_t getNumWords() const { return (tableSize + 63) / 64; }
 
     /** insert in pos position of hash table */
-    void setBit(unsigned int pos);
+    void setBit(uint64_t pos);
 
     /** check if pos position in hash table is filled */
-    bool hasBit(unsigned int pos);
+    bool hasBit(uint64_t pos);
+
+    // no copies, the table or its mapping is owned
+    BasicBloomFilter(const BasicBloomFilter&);
+    BasicBloomFilter& operator=(const BasicBloomFilter&);
 
 public:
 
     /** Destructor for the bloom filter */
-    ~BloomFilter();
-
-    /** Create a new bloom filter with the size in bytes */
-    BloomFilter(uint64_t numBytes);
+    ~BasicBloomFilter() override;
+
+    /** Create a new bloom filter with the size in bytes. numHashes is
+     *  clamped to [1, MAX_HASHES].
+     */
+    BasicBloomFilter(uint64_t numBytes, ProbeMode mode = DOUBLE_HASH,
+            unsigned int numHashes = DEFAULT_HASHES,
+            TableMemory memory = HEAP_TABLE);
+
+    /** Create a bloom filter sized to hold numItems at false positive rate
+     *  fpRate, using the optimal number of hashes for that size. A named
+     *  factory rather than a constructor, since (numItems, 3) would pick a
+     *  (uint64_t, double) overload over the hash count. The caller owns the
+     *  returned filter.
+     */
+    static BasicBloomFilter* forRate(uint64_t numItems, double fpRate,
+            ProbeMode mode = DOUBLE_HASH, TableMemory memory = HEAP_TABLE);
+
+    /** Bytes needed to hold numItems at false positive rate fpRate */
+    static uint64_t optimalNumBytes(uint64_t numItems, double fpRate);
+
+    /** Number of hashes minimizing false positives for numItems in numBytes */
+    static unsigned int optimalNumHashes(uint64_t numItems, uint64_t numBytes);
+
+    /** Map a 64-bit hash onto [0, range) with a multiply and a shift
+     *  (Lemire's fastrange) instead of a 64-bit modulo
+     */
+    static uint64_t fastRange(uint64_t hash, uint64_t range) {
+        return (uint64_t)(((unsigned __int128)hash * range) >> 64);
+    }
+
+    /** Hash str and fill pos with numHashes bit positions in a table of
+     *  tableSize bits. Shared by every filter using the same probe scheme.
+     */
+    static void hashPositions(const char* str, size_t len, ProbeMode mode,
+            unsigned int numHashes, uint64_t tableSize, uint64_t* pos);
+
+    /** Fill pos with the numHashes double hashing positions of a 128-bit
+     *  hash output in a table of tableSize bits
+     */
+    static void doubleHashPositions(const uint64_t* output,
+            unsigned int numHashes, uint64_t tableSize, uint64_t* pos);
+
+    /** Expected false positive rate once numItems have been inserted */
+    double expectedFPR(uint64_t numItems) const;
+
+    /** Size of the table in bytes */
+    uint64_t getNumBytes() const override { return tableSize / 8; }
+
+    /** Number of bits set per item */
+    unsigned int getNumHashes() const { return numHashes; }
+
+    /** Number of items inserted, duplicates included */
+    uint64_t getNumItems() const override { return numItems; }
+
+    /** Fraction of the table's bits that are set */
+    double fillRatio() const;
+
+    /** False positive rate estimated from the fill ratio of the table */
+    double estimatedFPR() const;
+
+    /** Write the filter's geometry, fill and estimated false positive rate
+     *  as a JSON object, with operation counts and latency percentiles if
+     *  built with FILTER_STATS
+     */
+    void dumpStats(ostream& out) const override;
+
+    /** Whether the table got explicit huge pages or was advised onto
+     *  transparent ones
+     */
+    bool hasHugePages() const { return hugePages; }
+
+    /** Write the filter to fileName in the versioned binary format: a fixed
+     *  header (table bits, hashes, seeds, probe mode, hash policy, item
+     *  count) followed by
+     *  the raw table. Returns false if the file could not be written.
+     */
+    bool save(string fileName) const override;
+
+    /** Map a filter written by save() without copying its table. Returns
+     *  nullptr if the file is missing, truncated or from an incompatible
+     *  version or hash scheme. The caller owns the returned filter.
+     */
+    static BasicBloomFilter* load(string fileName);
+
+    /** Insert an item of len bytes into the bloom filter, hashed in place */
+    void insert(const char* item, size_t len) override;
+
+    /** Determine whether an item of len bytes is in the bloom filter */
+    bool find(const char* item, size_t len) override;
 
     /** Insert an item into the bloom filter */
-    void insert(std::string item);
+    void insert(const std::string& item) { insert(item.data(), item.size()); }
 
     /** Determine whether an item is in the bloom filter */
-    bool find(std::string item);
+    bool find(const std::string& item) { return find(item.data(), item.size()); }
+
+    /** Determine for each of the n keys of lens[i] bytes whether it is in the
+     *  bloom filter, storing the answers in out. Hashes a batch of keys and
+     *  prefetches their table bytes before testing any of them.
+     */
+    void findBatch(const char* const* keys, const size_t* lens, size_t n,
+            bool* out) override;
+
+    /** Determine for each of the n strings whether it is in the bloom filter */
+    void findBatch(const std::string* keys, size_t n, bool* out);
+
+    /** Insert the n keys of lens[i] bytes, hashing them in batches */
+    void insertBatch(const char* const* keys, const size_t* lens, size_t n);
+
+    /** Insert the n strings, hashing them in batches */
+    void insertBatch(const std::string* keys, size_t n);
+
+    /** Add every item of other to this filter by OR-ing the tables.
+     *  Returns false if the filters differ in size, hashes or probe mode.
+     */
+    bool unionWith(const BasicBloomFilter& other);
 
     /** train bloom filter */
-    void trainFilter(ifstream& file, string badUrls, BloomFilter& filter);
+    void trainFilter(ifstream& file, string badUrls, BasicBloomFilter& filter);
 
-    /** read file of urls and write good urls to an output file */
-    void processURLs(ifstream& file, string goodUrls, ofstream& output,
-            string outputFile, double& numOutput, double& numUrls);
+    /** train bloom filter with numThreads threads, each building a partial
+     *  filter from one line-aligned byte range of badUrls, then merge them
+     */
+    void trainFilterParallel(string badUrls, unsigned int numThreads);
 
 };
+
+/** Bloom filter hashed with MurmurHash3_x64_128, the default hash */
+typedef BasicBloomFilter<Murmur3x64Hash> BloomFilter;
+
 #endif // BLOOM_FILTER
@@ -0,0 +1,182 @@
+/**
+ * Filename:     ClassifyPipeline.cpp
+ *
+ * Team:         Brandon Olmos (bolmos@ucsd.edu),
+ *               Daryl Nakamoto (dnakamot@ucsd.edu)
+ *
+ * Reference(s): cplusplus.com
+ *
+ * Description:  Multi-threaded url classification. Urls are never copied:
+ *               chunks hold pointer/length views into the mapped input,
+ *               which outlives every stage.
+ */
+
+#include "ClassifyPipeline.hpp"
+#include "FileIO.hpp"
+#include <chrono>
+#include <map>
+#include <thread>
+
+using namespace std;
+
+/** seconds elapsed since start */
+static double secondsSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start)
+        .count();
+}
+
+/** Create a pipeline over filter with numWorkers lookup threads */
+ClassifyPipeline::ClassifyPipeline(MembershipFilter& filter,
+        unsigned int numWorkers, bool keepOrder)
+    : filter(filter), numWorkers(numWorkers ? numWorkers : 1),
+      keepOrder(keepOrder), readStats(), lookupStats(), writeStats(),
+      wallSeconds(0)
+{
+}
+
+/** read file of urls and write good urls to an output file */
+bool ClassifyPipeline::processURLs(string goodUrls, ofstream& output,
+        string outputFile, double& numOutput, double& numUrls) {
+
+    MappedFile input;
+    if(!input.open(goodUrls)) return false;
+
+    WorkQueue<Chunk*> toLookup;
+    WorkQueue<Chunk*> toWrite;
+    vector<thread> workers;
+    mutex statsLock;
+    auto wallStart = chrono::steady_clock::now();
+
+    // reader: split the mapped file into chunks of line views
+    thread reader([&]() {
+        uint64_t seq = 0;
+        bool more = true;
+
+        while(more) {
+            auto start = chrono::steady_clock::now();
+            Chunk* chunk = new Chunk();
+            const char* url;
+            size_t len;
+
+            chunk->seq = seq++;
+            chunk->urls.reserve(CHUNK_URLS);
+            chunk->lens.reserve(CHUNK_URLS);
+
+            while(chunk->urls.size() < CHUNK_URLS &&
+                    (more = input.nextLine(url, len))) {
+                chunk->urls.push_back(url);
+                chunk->lens.push_back(len);
+            }
+
+            readStats.seconds += secondsSince(start);
+            readStats.numUrls += chunk->urls.size();
+
+            // an empty final chunk still keeps the sequence contiguous
+            toLookup.push(chunk);
+        }
+
+        toLookup.close();
+    });
+
+    // workers: classify whole chunks with batched lookups
+    for(unsigned int w = 0; w < numWorkers; ++w) {
+        workers.push_back(thread([&]() {
+            Chunk* chunk;
+
+            while(toLookup.pop(chunk)) {
+                auto start = chrono::steady_clock::now();
+
+                filter.findBatch(chunk->urls.data(), chunk->lens.data(),
+                                 chunk->urls.size(), chunk->isBadURL);
+
+                double seconds = secondsSince(start);
+                {
+                    lock_guard<mutex> guard(statsLock);
+                    lookupStats.seconds += seconds;
+                    lookupStats.numUrls += chunk->urls.size();
+                }
+
+                toWrite.push(chunk);
+            }
+        }));
+    }
+
+    // writer: runs on this thread, reordering chunks if asked to
+    output.open(outputFile, ios::binary);
+    {
+        BufferedWriter writer(output);
+        map<uint64_t, Chunk*> pending; // finished early, waiting for order
+        uint64_t nextSeq = 0;
+        Chunk* chunk;
+
+        // workers close the write queue once the last of them is done
+        thread closer([&]() {
+            for(auto& worker : workers)
+                worker.join();
+            toWrite.close();
+        });
+
+        while(toWrite.pop(chunk)) {
+            auto start = chrono::steady_clock::now();
+
+            if(keepOrder) {
+                pending[chunk->seq] = chunk;
+                chunk = nullptr;
+            }
+
+            // write the given chunk, or every chunk that is now in order
+            while(chunk || (!pending.empty() &&
+                        pending.begin()->first == nextSeq)) {
+                if(!chunk) {
+                    chunk = pending.begin()->second;
+                    pending.erase(pending.begin());
+                    ++nextSeq;
+                }
+
+                for(size_t i = 0; i < chunk->urls.size(); ++i) {
+                    if(!chunk->isBadURL[i]) {
+                        writer.writeLine(chunk->urls[i], chunk->lens[i]);
+                        ++numOutput;
+                    }
+                }
+
+                numUrls += chunk->urls.size();
+                writeStats.numUrls += chunk->urls.size();
+                delete chunk;
+                chunk = nullptr;
+            }
+
+            writeStats.seconds += secondsSince(start);
+        }
+
+        reader.join();
+        closer.join();
+    }
+    output.close();
+
+    wallSeconds = secondsSince(wallStart);
+    return true;
+}
+
+/** print the throughput of each stage */
+void ClassifyPipeline::printStats(ostream& out) const {
+
+    const StageStats* stages[] = { &readStats, &lookupStats, &writeStats };
+    const char* names[] = { "read", "lookup", "write" };
+
+    out << "Pipeline: " << numWorkers << " lookup worker(s), "
+        << (keepOrder ? "ordered" : "unordered") << " output" << endl;
+
+    // per-stage rate over the time that stage spent working
+    for(int i = 0; i < 3; ++i) {
+        out << "  " << names[i] << ": " << stages[i]->numUrls << " urls in "
+            << stages[i]->seconds << " s busy, "
+            << (stages[i]->seconds > 0
+                ? stages[i]->numUrls / stages[i]->seconds : 0)
+            << " urls/sec" << endl;
+    }
+
+    out << "  overall: "
+        << (wallSeconds > 0 ? writeStats.numUrls / wallSeconds : 0)
+        << " urls/sec" << endl;
+}
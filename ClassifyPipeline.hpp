@@ -0,0 +1,134 @@
+/**
+ * Filename:     ClassifyPipeline.hpp
+ *
+ * Team:         Brandon Olmos (bolmos@ucsd.edu),
+ *               Daryl Nakamoto (dnakamot@ucsd.edu)
+ *
+ * Reference(s): cplusplus.com
+ *
+ * Description:  Multi-threaded url classification. A reader thread splits
+ *               the mapped url file into chunks, a pool of workers looks
+ *               each chunk up in the filter, and a writer thread
+ *               writes the safe urls, in input order or as chunks finish.
+ */
+
+#ifndef CLASSIFY_PIPELINE_HPP
+#define CLASSIFY_PIPELINE_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "MembershipFilter.hpp"
+
+#define CHUNK_URLS 4096    // urls handed to a worker at a time
+#define MAX_QUEUED_CHUNKS 64 // chunks waiting per queue before a stage blocks
+
+using namespace std;
+
+/**
+ * Blocking FIFO shared between pipeline stages. push blocks while the queue
+ * is full, pop blocks while it is empty and returns false once the queue is
+ * closed and drained.
+ */
+template<class T>
+class WorkQueue {
+
+private:
+
+    deque<T> items;
+    mutex lock;
+    condition_variable notEmpty;
+    condition_variable notFull;
+    bool closed;
+
+public:
+
+    /** Create an empty open queue */
+    WorkQueue() : closed(false) {}
+
+    /** Add item, waiting for room */
+    void push(T item) {
+        unique_lock<mutex> guard(lock);
+        notFull.wait(guard, [this]() {
+            return items.size() < MAX_QUEUED_CHUNKS;
+        });
+
+        items.push_back(item);
+        notEmpty.notify_one();
+    }
+
+    /** Take the oldest item. Returns false when closed and empty. */
+    bool pop(T& item) {
+        unique_lock<mutex> guard(lock);
+        notEmpty.wait(guard, [this]() { return closed || !items.empty(); });
+
+        if(items.empty()) return false;
+
+        item = items.front();
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    /** No more items will be pushed; wake everyone waiting */
+    void close() {
+        lock_guard<mutex> guard(lock);
+        closed = true;
+        notEmpty.notify_all();
+    }
+};
+
+/** Busy time and url count of one stage, for throughput reports */
+struct StageStats {
+    double seconds; // time spent working, summed over the stage's threads
+    double numUrls;
+};
+
+/**
+ * Reader -> lookup workers -> writer pipeline classifying a url file with a
+ * trained filter. The filter is only read, so workers share it.
+ */
+class ClassifyPipeline {
+
+private:
+
+    /** A run of urls from the mapped input and their classification */
+    struct Chunk {
+        uint64_t seq; // position of the chunk in the input
+        vector<const char*> urls;
+        vector<size_t> lens;
+        bool isBadURL[CHUNK_URLS];
+    };
+
+    MembershipFilter& filter;
+    unsigned int numWorkers;
+    bool keepOrder;
+
+    StageStats readStats;
+    StageStats lookupStats;
+    StageStats writeStats;
+    double wallSeconds;
+
+public:
+
+    /** Create a pipeline over filter with numWorkers lookup threads. With
+     *  keepOrder false, chunks are written as soon as they are classified.
+     */
+    ClassifyPipeline(MembershipFilter& filter, unsigned int numWorkers,
+            bool keepOrder = true);
+
+    /** read file of urls and write good urls to an output file. Returns
+     *  false if goodUrls cannot be mapped.
+     */
+    bool processURLs(string goodUrls, ofstream& output, string outputFile,
+            double& numOutput, double& numUrls);
+
+    /** print the throughput of each stage */
+    void printStats(ostream& out) const;
+};
+
+#endif // CLASSIFY_PIPELINE_HPP
@@ -0,0 +1,187 @@
+/**
+ * Filename:     ConcurrentBloomFilter.cpp
+ *
+ * Team:         Brandon Olmos (bolmos@ucsd.edu),
+ *               Daryl Nakamoto (dnakamot@ucsd.edu)
+ *
+ * Reference(s): cplusplus.com
+ *               https://github.com/aappleby/smhasher/wiki/MurmurHash3
+ *
+ * Description:  Thread-safe bloom filter. Inserts use a relaxed fetch_or on
+ *               the word holding each bit; bits are only ever set, so no
+ *               ordering between threads is needed. Lookups use relaxed
+ *               loads.
+ */
+
+#include "ConcurrentBloomFilter.hpp"
+#include "FileIO.hpp"
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+using namespace std;
+
+/** Create a new concurrent bloom filter with the size in bytes. numHashes
+ *  is clamped to [1, MAX_HASHES]
+ */
+ConcurrentBloomFilter::ConcurrentBloomFilter(uint64_t numBytes,
+        ProbeMode mode, unsigned int numHashes)
+    : numHashes(numHashes), mode(mode)
+{
+    if(numBytes == 0) numBytes = 1;
+    if(this->numHashes == 0) this->numHashes = 1;
+    if(this->numHashes > MAX_HASHES) this->numHashes = MAX_HASHES;
+
+    tableSize = numBytes * 8; // 8 bits per Byte
+    numWords = (tableSize + 63) / 64;
+    table = new atomic<uint64_t>[numWords];
+
+    // set all bits in table to 0
+    for(uint64_t i = 0; i < numWords; ++i)
+        table[i].store(0, memory_order_relaxed);
+}
+
+/** Create a concurrent bloom filter sized to hold numItems at false positive
+ *  rate fpRate
+ */
+ConcurrentBloomFilter* ConcurrentBloomFilter::forRate(uint64_t numItems,
+        double fpRate, ProbeMode mode) {
+
+    uint64_t numBytes = BloomFilter::optimalNumBytes(numItems, fpRate);
+
+    return new ConcurrentBloomFilter(numBytes, mode,
+            BloomFilter::optimalNumHashes(numItems, numBytes));
+}
+
+/** Destructor for the concurrent bloom filter */
+ConcurrentBloomFilter::~ConcurrentBloomFilter()
+{
+    delete[] table;
+}
+
+/** Insert an item of len bytes into the bloom filter. Thread-safe. */
+void ConcurrentBloomFilter::insert(const char* item, size_t len)
+{
+    uint64_t pos[numHashes];
+
+    BloomFilter::hashPositions(item, len, mode, numHashes, tableSize, pos);
+
+    // skip the atomic write when the bit is already set
+    for(unsigned int i = 0; i < numHashes; ++i) {
+        atomic<uint64_t>& word = table[pos[i] / 64];
+        uint64_t bit = (uint64_t)1 << (pos[i] % 64);
+
+        if(!(word.load(memory_order_relaxed) & bit))
+            word.fetch_or(bit, memory_order_relaxed);
+    }
+}
+
+/** Determine whether an item of len bytes is in the bloom filter */
+bool ConcurrentBloomFilter::find(const char* item, size_t len) const
+{
+    uint64_t pos[numHashes];
+
+    BloomFilter::hashPositions(item, len, mode, numHashes, tableSize, pos);
+
+    for(unsigned int i = 0; i < numHashes; ++i) {
+        uint64_t word = table[pos[i] / 64].load(memory_order_relaxed);
+
+        if(!(word & ((uint64_t)1 << (pos[i] % 64))))
+            return false;
+    }
+
+    return true;
+}
+
+/** Insert the n items split across numThreads threads */
+void ConcurrentBloomFilter::insertAll(const string* items, size_t n,
+        unsigned int numThreads)
+{
+    if(numThreads == 0) numThreads = 1;
+
+    vector<thread> workers;
+    size_t perThread = (n + numThreads - 1) / numThreads;
+
+    // each thread inserts one contiguous slice of the items
+    for(unsigned int t = 0; t < numThreads; ++t) {
+        size_t start = t * perThread;
+        size_t end = start + perThread < n ? start + perThread : n;
+
+        if(start >= end) break;
+
+        workers.push_back(thread([this, items, start, end]() {
+            for(size_t i = start; i < end; ++i)
+                insert(items[i]);
+        }));
+    }
+
+    for(auto& worker : workers)
+        worker.join();
+}
+
+/** train bloom filter from the file badUrls using numThreads threads */
+void ConcurrentBloomFilter::trainFilter(string badUrls,
+        unsigned int numThreads)
+{
+    if(numThreads == 0) numThreads = 1;
+
+    MappedFile file;
+    if(!file.open(badUrls)) {
+        // not mappable (e.g. a pipe): read it here, insert in parallel
+        ifstream input(badUrls);
+        vector<string> urls;
+        string url;
+
+        while(getline(input, url))
+            urls.push_back(url);
+
+        insertAll(urls.data(), urls.size(), numThreads);
+        return;
+    }
+
+    const char* data = file.begin();
+    uint64_t size = file.getSize();
+    uint64_t perThread = (size + numThreads - 1) / numThreads;
+    vector<thread> workers;
+
+    // each thread inserts the lines starting in one byte range of the file
+    for(unsigned int t = 0; t < numThreads; ++t) {
+        uint64_t start = t * perThread;
+        uint64_t end = start + perThread < size ? start + perThread : size;
+
+        if(start >= end) break;
+
+        workers.push_back(thread([this, data, size, start, end]() {
+            insertLines(data, size, start, end);
+        }));
+    }
+
+    for(auto& worker : workers)
+        worker.join();
+}
+
+/** Insert the lines of the size bytes at data whose first byte lies in
+ *  [start, end), read in place
+ */
+void ConcurrentBloomFilter::insertLines(const char* data, uint64_t size,
+        uint64_t start, uint64_t end)
+{
+    const char* line = data + start;
+    const char* last = data + size;
+
+    // the line already started before start belongs to the range before
+    if(start > 0 && data[start - 1] != '\n') {
+        line = (const char*)memchr(line, '\n', last - line);
+        if(!line) return;
+        ++line;
+    }
+
+    // a final line without a newline still counts, as with getline
+    while(line < data + end) {
+        const char* eol = (const char*)memchr(line, '\n', last - line);
+        if(!eol) eol = last;
+
+        insert(line, eol - line);
+        line = eol + 1;
+    }
+}
@@ -0,0 +1,104 @@
+/**
+ * Filename:     ConcurrentBloomFilter.hpp
+ *
+ * Team:         Brandon Olmos (bolmos@ucsd.edu),
+ *               Daryl Nakamoto (dnakamot@ucsd.edu)
+ *
+ * Reference(s): cplusplus.com
+ *               https://github.com/aappleby/smhasher/wiki/MurmurHash3
+ *
+ * Description:  Thread-safe bloom filter. Bits are set with atomic fetch-or
+ *               on 64-bit words, so any number of threads may insert and
+ *               look up items at the same time.
+ */
+
+#ifndef CONCURRENT_BLOOM_FILTER_HPP
+#define CONCURRENT_BLOOM_FILTER_HPP
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "BloomFilter.hpp"
+
+using namespace std;
+
+/**
+ * Bloom filter that can be trained and queried from several threads at once.
+ * Uses the same probe positions as BloomFilter for the same size and hashes.
+ */
+class ConcurrentBloomFilter {
+
+private:
+
+    // table of 64-bit words, bits are set with fetch_or
+    atomic<uint64_t>* table;
+    uint64_t tableSize;
+    uint64_t numWords;
+
+    // number of bits set per item
+    unsigned int numHashes;
+
+    // how probe positions are generated for an item
+    ProbeMode mode;
+
+    /** Insert the lines of the size bytes at data whose first byte lies in
+     *  [start, end), read in place
+     */
+    void insertLines(const char* data, uint64_t size, uint64_t start,
+            uint64_t end);
+
+    // no copies, the table is owned
+    ConcurrentBloomFilter(const ConcurrentBloomFilter&);
+    ConcurrentBloomFilter& operator=(const ConcurrentBloomFilter&);
+
+public:
+
+    /** Destructor for the concurrent bloom filter */
+    ~ConcurrentBloomFilter();
+
+    /** Create a new concurrent bloom filter with the size in bytes.
+     *  numHashes is clamped to [1, MAX_HASHES].
+     */
+    ConcurrentBloomFilter(uint64_t numBytes, ProbeMode mode = DOUBLE_HASH,
+            unsigned int numHashes = DEFAULT_HASHES);
+
+    /** Create a concurrent bloom filter sized to hold numItems at false
+     *  positive rate fpRate. A factory, like BloomFilter::forRate(), so
+     *  (numBytes, 3) cannot be taken for a rate. The caller owns the
+     *  returned filter.
+     */
+    static ConcurrentBloomFilter* forRate(uint64_t numItems, double fpRate,
+            ProbeMode mode = DOUBLE_HASH);
+
+    /** Insert an item of len bytes into the bloom filter. Thread-safe. */
+    void insert(const char* item, size_t len);
+
+    /** Determine whether an item of len bytes is in the bloom filter.
+     *  Thread-safe; may miss items inserted concurrently with the call.
+     */
+    bool find(const char* item, size_t len) const;
+
+    /** Insert an item into the bloom filter */
+    void insert(const std::string& item) { insert(item.data(), item.size()); }
+
+    /** Determine whether an item is in the bloom filter */
+    bool find(const std::string& item) const {
+        return find(item.data(), item.size());
+    }
+
+    /** Insert the n items split across numThreads threads */
+    void insertAll(const std::string* items, size_t n, unsigned int numThreads);
+
+    /** train bloom filter from the file badUrls using numThreads threads,
+     *  each inserting the lines of one byte range of the mapped file
+     */
+    void trainFilter(string badUrls, unsigned int numThreads);
+
+    /** Size of the table in bytes */
+    uint64_t getNumBytes() const { return tableSize / 8; }
+
+    /** Number of bits set per item */
+    unsigned int getNumHashes() const { return numHashes; }
+};
+#endif // CONCURRENT_BLOOM_FILTER_HPP
@@ -0,0 +1,143 @@
+/**
+ * Filename:     CountingBloomFilter.cpp
+ *
+ * Team:         Brandon Olmos (bolmos@ucsd.edu),
+ *               Daryl Nakamoto (dnakamot@ucsd.edu)
+ *
+ * Reference(s): cplusplus.com
+ *               https://github.com/aappleby/smhasher/wiki/MurmurHash3
+ *
+ * Description:  Counting bloom filter with packed 4-bit saturating counters.
+ *               Probe positions come from BloomFilter::hashPositions, so an
+ *               item maps to the same positions as in a BloomFilter of
+ *               numCounters bits.
+ */
+
+#include "CountingBloomFilter.hpp"
+#include <cstring>
+#include <fstream>
+
+#define NIBBLE_BITS 4
+#define NIBBLE_MASK 0xF
+
+using namespace std;
+
+/** Create a new counting bloom filter with numCounters counters. numHashes
+ *  is clamped to [1, MAX_HASHES]
+ */
+CountingBloomFilter::CountingBloomFilter(uint64_t numCounters,
+        ProbeMode mode, unsigned int numHashes)
+    : numCounters(numCounters ? numCounters : 1),
+      numHashes(numHashes), mode(mode)
+{
+    if(this->numHashes == 0) this->numHashes = 1;
+    if(this->numHashes > MAX_HASHES) this->numHashes = MAX_HASHES;
+
+    table = new unsigned char[getNumBytes()];
+
+    // set all counters in table to 0
+    memset(table, 0, getNumBytes());
+}
+
+/** Create a counting bloom filter sized to hold numItems at false positive
+ *  rate fpRate; one counter per bit of the equivalent BloomFilter
+ */
+CountingBloomFilter* CountingBloomFilter::forRate(uint64_t numItems,
+        double fpRate, ProbeMode mode) {
+
+    uint64_t numBytes = BloomFilter::optimalNumBytes(numItems, fpRate);
+
+    return new CountingBloomFilter(8 * numBytes, mode,
+            BloomFilter::optimalNumHashes(numItems, numBytes));
+}
+
+/** Destructor for the counting bloom filter */
+CountingBloomFilter::~CountingBloomFilter()
+{
+    delete[] table;
+}
+
+/** value of the counter at pos */
+unsigned int CountingBloomFilter::getCounter(uint64_t pos) const {
+    return (table[pos / 2] >> (pos % 2 * NIBBLE_BITS)) & NIBBLE_MASK;
+}
+
+/** add delta (+1 or -1) to the counter at pos unless it is saturated */
+void CountingBloomFilter::addCounter(uint64_t pos, int delta) {
+
+    unsigned int counter = getCounter(pos);
+    unsigned int shift = pos % 2 * NIBBLE_BITS;
+
+    // a saturated counter has lost its count, and an empty one has none
+    if(counter == COUNTER_MAX || (delta < 0 && counter == 0)) return;
+
+    counter += delta;
+    table[pos / 2] = (table[pos / 2] & ~(NIBBLE_MASK << shift)) |
+                     (counter << shift);
+}
+
+/** Insert an item of len bytes into the bloom filter */
+void CountingBloomFilter::insert(const char* item, size_t len)
+{
+    uint64_t pos[numHashes];
+
+    BloomFilter::hashPositions(item, len, mode, numHashes, numCounters, pos);
+
+    for(unsigned int i = 0; i < numHashes; ++i)
+        addCounter(pos[i], 1);
+}
+
+/** Remove an item of len bytes that was inserted before. Returns false,
+ *  changing nothing, if the item is definitely not in the filter.
+ */
+bool CountingBloomFilter::remove(const char* item, size_t len)
+{
+    uint64_t pos[numHashes];
+
+    BloomFilter::hashPositions(item, len, mode, numHashes, numCounters, pos);
+
+    for(unsigned int i = 0; i < numHashes; ++i) {
+        if(getCounter(pos[i]) == 0)
+            return false;
+    }
+
+    for(unsigned int i = 0; i < numHashes; ++i)
+        addCounter(pos[i], -1);
+
+    return true;
+}
+
+/** Determine whether an item of len bytes is in the bloom filter */
+bool CountingBloomFilter::find(const char* item, size_t len) const
+{
+    uint64_t pos[numHashes];
+
+    BloomFilter::hashPositions(item, len, mode, numHashes, numCounters, pos);
+
+    for(unsigned int i = 0; i < numHashes; ++i) {
+        if(getCounter(pos[i]) == 0)
+            return false;
+    }
+
+    return true;
+}
+
+/** insert every url in the file addedUrls */
+void CountingBloomFilter::trainFilter(string addedUrls) {
+
+    ifstream file(addedUrls);
+    string url;
+
+    while(getline(file, url))
+        insert(url);
+}
+
+/** remove every url in the file removedUrls */
+void CountingBloomFilter::removeURLs(string removedUrls) {
+
+    ifstream file(removedUrls);
+    string url;
+
+    while(getline(file, url))
+        remove(url);
+}
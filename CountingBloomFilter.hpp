@@ -0,0 +1,113 @@
+/**
+ * Filename:     CountingBloomFilter.hpp
+ *
+ * Team:         Brandon Olmos (bolmos@ucsd.edu),
+ *               Daryl Nakamoto (dnakamot@ucsd.edu)
+ *
+ * Reference(s): cplusplus.com
+ *               https://github.com/aappleby/smhasher/wiki/MurmurHash3
+ *
+ * Description:  Counting bloom filter. Every position holds a 4-bit counter
+ *               instead of a bit, so items can be removed as well as added.
+ */
+
+#ifndef COUNTING_BLOOM_FILTER_HPP
+#define COUNTING_BLOOM_FILTER_HPP
+
+#include <string>
+#include <stdint.h>
+#include "BloomFilter.hpp"
+
+#define COUNTER_MAX 15 // 4-bit counters saturate here and stay there
+
+using namespace std;
+
+/**
+ * Bloom filter of packed 4-bit saturating counters, two per byte. Supports
+ * remove() for items that were inserted. A counter that reached COUNTER_MAX
+ * is never decremented again, since its true count is unknown; this keeps
+ * the no false negative guarantee at the cost of a few stuck positions.
+ * Uses the same probe positions as BloomFilter.
+ */
+class CountingBloomFilter {
+
+private:
+
+    // two counters per byte, low nibble first
+    unsigned char* table;
+    uint64_t numCounters;
+
+    // number of counters incremented per item
+    unsigned int numHashes;
+
+    // how probe positions are generated for an item
+    ProbeMode mode;
+
+    /** value of the counter at pos */
+    unsigned int getCounter(uint64_t pos) const;
+
+    /** add delta (+1 or -1) to the counter at pos unless it is saturated */
+    void addCounter(uint64_t pos, int delta);
+
+    // no copies, the table is owned
+    CountingBloomFilter(const CountingBloomFilter&);
+    CountingBloomFilter& operator=(const CountingBloomFilter&);
+
+public:
+
+    /** Destructor for the counting bloom filter */
+    ~CountingBloomFilter();
+
+    /** Create a new counting bloom filter with numCounters counters,
+     *  taking numCounters / 2 bytes. numHashes is clamped to
+     *  [1, MAX_HASHES].
+     */
+    CountingBloomFilter(uint64_t numCounters, ProbeMode mode = DOUBLE_HASH,
+            unsigned int numHashes = DEFAULT_HASHES);
+
+    /** Create a counting bloom filter sized to hold numItems at false
+     *  positive rate fpRate. A factory, like BloomFilter::forRate(), so
+     *  (numCounters, 3) cannot be taken for a rate. The caller owns the
+     *  returned filter.
+     */
+    static CountingBloomFilter* forRate(uint64_t numItems, double fpRate,
+            ProbeMode mode = DOUBLE_HASH);
+
+    /** Insert an item of len bytes into the bloom filter */
+    void insert(const char* item, size_t len);
+
+    /** Remove an item of len bytes that was inserted before. Returns false,
+     *  changing nothing, if the item is definitely not in the filter.
+     *  Removing an item that was never inserted corrupts the filter.
+     */
+    bool remove(const char* item, size_t len);
+
+    /** Determine whether an item of len bytes is in the bloom filter */
+    bool find(const char* item, size_t len) const;
+
+    /** Insert an item into the bloom filter */
+    void insert(const std::string& item) { insert(item.data(), item.size()); }
+
+    /** Remove an item that was inserted before */
+    bool remove(const std::string& item) {
+        return remove(item.data(), item.size());
+    }
+
+    /** Determine whether an item is in the bloom filter */
+    bool find(const std::string& item) const {
+        return find(item.data(), item.size());
+    }
+
+    /** insert every url in the file addedUrls */
+    void trainFilter(string addedUrls);
+
+    /** remove every url in the file removedUrls */
+    void removeURLs(string removedUrls);
+
+    /** Size of the table in bytes */
+    uint64_t getNumBytes() const { return (numCounters + 1) / 2; }
+
+    /** Number of counters incremented per item */
+    unsigned int getNumHashes() const { return numHashes; }
+};
+#endif // COUNTING_BLOOM_FILTER_HPP
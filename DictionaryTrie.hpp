@@ -9,6 +9,9 @@
  * Description:  Ternery trie to hold strings and their corresponding
  *               occuring frequency. Suggest n most probable word completions
  *               based on frequency of words with a particular prefix.
+ *               The trie can be built a word at a time or in bulk from
+ *               sorted words, and frozen into a flat binary image that
+ *               later runs map and query in place.
  */
 
 #ifndef DICTIONARYTRIE_HPP
@@ -17,12 +20,34 @@
 #include <vector>
 #include <string>
 #include <queue>
+#include <algorithm> // stable_sort(), max()
+#include <utility>   // move()
+#include <fstream>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "TNode.hpp"
 
 #define EMPTYSTR ""
+#define TRIE_FILE_MAGIC "TSTFROZN" // first 8 bytes of a frozen trie
+#define TRIE_FILE_VERSION 1
+#define TRIE_HEADER_BYTES 64       // nodes start on a cache line of the file
 typedef pair<string, int> Word;
 
 using namespace std;
+
+/** Header of a frozen trie, written in host byte order */
+struct TrieHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t nodeBytes; // sizeof(TNode) of the writer
+    uint32_t numNodes;  // node slots that follow, unused slot 0 included
+    unsigned char padding[TRIE_HEADER_BYTES - 20];
+};
+
+static_assert(sizeof(TrieHeader) == TRIE_HEADER_BYTES, "trie header size");
 /**
  *  The class for a dictionary ADT, implemented as a ternery trie
  */
@@ -42,18 +67,91 @@ private:
         }
     };
 
+    // every node of the trie, released together
+    TNodeArena nodes;
+
     TNode* root;
 
+    /** Node at index, nullptr for NULL_NODE */
+    TNode* child(uint32_t index) const {
+        return index == NULL_NODE ? nullptr : nodes.get(index);
+    }
+
+    /** Orders words the way the trie orders characters, as plain
+     *  (signed) chars, with a prefix before its extensions
+     */
+    struct TrieOrder {
+    public:
+        bool operator()(const Word& word1, const Word& word2) const
+        {
+            const string& str1 = word1.first;
+            const string& str2 = word2.first;
+            size_t length = min(str1.length(), str2.length());
+
+            for(size_t i = 0; i < length; ++i)
+                if(str1[i] != str2[i]) return str1[i] < str2[i];
+
+            return str1.length() < str2.length();
+        }
+    };
+
     // number of suggestions to return
     priority_queue<Word, vector<Word>, Compare> numComplete;
 
+    /** build() helper. Builds the left/right tree of the sorted words in
+     *  [lo, hi), which share their first depth characters and are all
+     *  longer than that, and returns its root. The root holds the
+     *  character of the median word, so each side gets half the words.
+     */
+    uint32_t buildRange(const vector<Word>& words, size_t lo, size_t hi,
+            size_t depth) {
+
+        if(lo == hi) return NULL_NODE;
+
+        // the run of words with the median word's character at depth
+        size_t mid = lo + (hi - lo) / 2;
+        char c = words[mid].first[depth];
+        size_t first = mid;
+        size_t last = mid + 1;
+
+        while(first > lo && words[first - 1].first[depth] == c) --first;
+        while(last < hi && words[last].first[depth] == c) ++last;
+
+        // allocated before its subtrees, so the root takes the first slot
+        uint32_t index = nodes.alloc(c);
+
+        // a word ending at this character sorts first in the run
+        size_t below = first;
+        int freq = 0;
+        if(words[below].first.length() == depth + 1)
+            freq = words[below++].second;
+
+        uint32_t left = buildRange(words, lo, first, depth);
+        uint32_t middle = buildRange(words, below, last, depth + 1);
+        uint32_t right = buildRange(words, last, hi, depth);
+
+        // subtree maximum from the children's, bottom up
+        TNode* curr = nodes.get(index);
+        curr->left = left;
+        curr->middle = middle;
+        curr->right = right;
+        curr->freq = freq;
+        curr->fmax = freq;
+
+        if(left) curr->fmax = max(curr->fmax, child(left)->fmax);
+        if(middle) curr->fmax = max(curr->fmax, child(middle)->fmax);
+        if(right) curr->fmax = max(curr->fmax, child(right)->fmax);
+
+        return index;
+    }
+
     /** PredictCompletions helper function; return ALL suggestions.
      *  Returns the frequency of the most frequent words in order.
      *  Traversed in order, so traversed in alphanumerical order.
      *  This is why the words can be directly inserted into a vector,
      *  rather than a priority queue.
      */
-    int getCompletions(string& word, TNode*& curr, int& highestFreq,
+    int getCompletions(string& word, TNode* curr, int& highestFreq,
             vector<string>& numComplete, unsigned int& num_completions) {
 
         // remember next best frequency and result from a recursive call
@@ -73,41 +171,44 @@ private:
             }
 
             // Search for words to the left and return next best if it was left
-            if (curr->left) {
-                if (curr->fleft >= highestFreq) {
-                    recResult = getCompletions(word, curr->left, highestFreq,
+            TNode* next = child(curr->left);
+            if (next) {
+                if (next->fmax >= highestFreq) {
+                    recResult = getCompletions(word, next, highestFreq,
                                                numComplete, num_completions);
 
                     // check if found a better next frequency
                     if (recResult > nextBest) nextBest = recResult;
-                } else if (curr->fleft > nextBest)
-                    nextBest = curr->fleft;
+                } else if (next->fmax > nextBest)
+                    nextBest = next->fmax;
             }
 
             // Search for words to the mid and return next best if it was mid
-            if (curr->middle) {
-                if (curr->fmid >= highestFreq) {
+            next = child(curr->middle);
+            if (next) {
+                if (next->fmax >= highestFreq) {
                     word.push_back(curr->_char);
-                    recResult = getCompletions(word, curr->middle, highestFreq,
+                    recResult = getCompletions(word, next, highestFreq,
                                                numComplete, num_completions);
                     word.pop_back();
 
                     // check if found a better next frequency
                     if (recResult > nextBest) nextBest = recResult;
-                } else if (curr->fmid > nextBest)
-                    nextBest = curr->fmid;
+                } else if (next->fmax > nextBest)
+                    nextBest = next->fmax;
             }
 
             //Search for words to the right and return next best if it was right
-            if (curr->right) {
-                if (curr->fright >= highestFreq) {
-                    recResult = getCompletions(word, curr->right, highestFreq,
+            next = child(curr->right);
+            if (next) {
+                if (next->fmax >= highestFreq) {
+                    recResult = getCompletions(word, next, highestFreq,
                                                numComplete, num_completions);
 
                     // check if found a better next frequency
                     if (recResult > nextBest) nextBest = recResult;
-                } else if (curr->fright > nextBest)
-                    nextBest = curr->fright;
+                } else if (next->fmax > nextBest)
+                    nextBest = next->fmax;
             }
 
             /** check if a next best was found. Will be false no more words with
@@ -141,26 +242,26 @@ private:
 
                 if(index == length && curr->freq > 0) return curr->freq;
 
-                else if(curr->middle == nullptr) return 0;
+                else if(curr->middle == NULL_NODE) return 0;
 
-                else curr = curr->middle;
+                else curr = child(curr->middle);
             }
 
             // check left
             else if(postUnderscore[index] < curr->_char)
             {
-                if(curr->left == nullptr) return 0;
+                if(curr->left == NULL_NODE) return 0;
 
-                else curr = curr->left;
+                else curr = child(curr->left);
             }
 
 
             // check right
             else
             {
-                if(curr->right == nullptr) return 0;
+                if(curr->right == NULL_NODE) return 0;
 
-                else curr = curr->right;
+                else curr = child(curr->right);
             }
         }
 
@@ -175,11 +276,11 @@ private:
 
         if(curr == nullptr) return;
 
-        getChildren(curr->left, children);
+        getChildren(child(curr->left), children);
 
         children.push(curr);
 
-        getChildren(curr->right, children);
+        getChildren(child(curr->right), children);
     }
 
 public:
@@ -194,30 +295,41 @@ public:
  * invalid (empty string). This might be useful for testing
  * when you want to test a certain case, but don't want to
  * write out a specific word 300 times.
+ * A trie loaded with loadFrozen() is read-only and rejects every word.
  */
-    bool insert(string word, int freq)
+    bool insert(const string& word, int freq)
+    {
+        return insert(word.data(), word.length(), freq);
+    }
+
+    /** Insert the len bytes at word, read in place, with frequency freq.
+     *  Same as insert(string, int) without building a string first.
+     */
+    bool insert(const char* word, size_t len, int freq)
     {
 
-        // reject empty string
-        if(word == EMPTYSTR) return false;
+        // reject empty string, and any word into a mapped image
+        if(len == 0 || nodes.isMapped()) return false;
 
         TNode* curr;
         int index = 0;
-        int length = word.length();
+        int length = len;
 
         // single character word AND initial build (empty trie)
         if(root == nullptr) {
 
-            root = new TNode(word[index]);
+            root = child(nodes.alloc(word[index]));
 
             if(length == 1) {
 
                 root->freq = freq;
+                root->fmax = freq;
                 return true;
             }
         }
 
         curr = root;
+        if(freq > root->fmax) root->fmax = freq;
 
         // start insertion
         while(index < length) {
@@ -227,20 +339,20 @@ public:
             // check middle child
             if(curr->_char == word[index])
             {
-                if(curr->middle == nullptr)
+                if(curr->middle == NULL_NODE)
                 {
                     // reject duplicate (no middle child)
                     if(index + 1 == length) return false;
 
                     else
                     {
-                        curr->middle = new TNode(word[index + 1]);
+                        curr->middle = nodes.alloc(word[index + 1]);
 
                         // done inserting word
                         if(index + 1 == length - 1)
                         {
-                            if(freq > curr->fmid) curr->fmid = freq;
-                            curr->middle->freq = freq;
+                            child(curr->middle)->fmax = freq;
+                            child(curr->middle)->freq = freq;
                             return true;
                         }
                     }
@@ -253,47 +365,47 @@ public:
                 }
 
                 // check next character in string
-                if(freq > curr->fmid) curr->fmid = freq;
-                curr = curr->middle;
+                curr = child(curr->middle);
+                if(freq > curr->fmax) curr->fmax = freq;
                 index++;
             }
 
             // check left child
             else if(word[index] < curr->_char)
             {
-                if(curr->left == nullptr)
+                if(curr->left == NULL_NODE)
                 {
                     // create new left node if necessary
-                    curr->left = new TNode(word[index]);
+                    curr->left = nodes.alloc(word[index]);
 
                     if (index + 1 == length) {
-                        if(freq > curr->fleft) curr->fleft = freq;
-                        curr->left->freq = freq;
+                        child(curr->left)->fmax = freq;
+                        child(curr->left)->freq = freq;
                         return true;
                     }
                 }
 
-                if(freq > curr->fleft) curr->fleft = freq;
-                curr = curr->left;
+                curr = child(curr->left);
+                if(freq > curr->fmax) curr->fmax = freq;
             }
 
             // check right child
             else
             {
-                if(curr->right == nullptr)
+                if(curr->right == NULL_NODE)
                 {
-                    curr->right = new TNode(word[index]);
+                    curr->right = nodes.alloc(word[index]);
 
                     if(index + 1 == length)
                     {
-                        if(freq > curr->fright) curr->fright = freq;
-                        curr->right->freq = freq;
+                        child(curr->right)->fmax = freq;
+                        child(curr->right)->freq = freq;
                         return true;
                     }
                 }
 
-                if(freq > curr->fright) curr->fright = freq;
-                curr = curr->right;
+                curr = child(curr->right);
+                if(freq > curr->fmax) curr->fmax = freq;
             }
 
         }
@@ -324,26 +436,26 @@ public:
 
               if(index == length && curr->freq > 0) return true;
 
-              else if(curr->middle == nullptr) return false;
+              else if(curr->middle == NULL_NODE) return false;
 
-              else curr = curr->middle;
+              else curr = child(curr->middle);
           }
 
           // check left
           else if(word[index] < curr->_char)
           {
-              if(curr->left == nullptr) return false;
+              if(curr->left == NULL_NODE) return false;
 
-              else curr = curr->left;
+              else curr = child(curr->left);
           }
 
 
           // check right
           else
           {
-              if(curr->right == nullptr) return false;
+              if(curr->right == NULL_NODE) return false;
 
-              else curr = curr->right;
+              else curr = child(curr->right);
           }
       }
 
@@ -382,14 +494,14 @@ public:
           if(curr->_char == prefix[index])
           {
               index += 1;
-              if(index != preLength) curr = curr->middle;
+              if(index != preLength) curr = child(curr->middle);
           }
 
           else if(prefix[index] < curr->_char)
-              curr = curr->left;
+              curr = child(curr->left);
 
           else
-              curr = curr->right;
+              curr = child(curr->right);
       }
 
       // prefix not found
@@ -398,7 +510,7 @@ public:
       int prefixFreq = curr->freq;
 
       // push to queue if prefix is largest word
-      int max = curr->fmid;
+      int max = curr->middle ? child(curr->middle)->fmax : 0;
 
       if(!max && prefixFreq)
           mostFreqStr.push_back(str);
@@ -411,7 +523,7 @@ public:
               prefixFreq = 0;
           }
 
-          max = getCompletions(str, curr->middle, max, mostFreqStr,
+          max = getCompletions(str, child(curr->middle), max, mostFreqStr,
                   num_completions);
       }
 //
@@ -459,17 +571,17 @@ public:
           {
               index++;
 
-              if(index != preLength) curr = curr->middle;
+              if(index != preLength) curr = child(curr->middle);
           }
 
           else if(pattern[index] < curr->_char)
           {
-              curr = curr->left;
+              curr = child(curr->left);
           }
 
           else
           {
-              curr = curr->right;
+              curr = child(curr->right);
           }
       }
 
@@ -495,7 +607,7 @@ public:
           curr = preUnderscore.front();
 
           if(curr->middle)
-            freq = postUnderscore(pattern.substr(index + 1, pattern.length()),curr->middle);
+            freq = postUnderscore(pattern.substr(index + 1, pattern.length()),child(curr->middle));
 
           if(freq) {
               pattern[index] = curr->_char;
@@ -516,23 +628,205 @@ public:
 
   }
 
-  /** Destructor */
-  ~DictionaryTrie() {
-     deleteTree(root);
+  /** Destructor. The arena releases every node at once. */
+  ~DictionaryTrie() {}
+
+  /** Remove every word, releasing all nodes at once */
+  void clear() {
+      nodes.clear();
+      root = nullptr;
   }
 
-  /** post-order traversal to delete trie */
-  void deleteTree(TNode* curr) {
-      if(curr == nullptr) return;
+  /** Lay the nodes out again for searching. The left/right tree of
+   *  siblings under one parent, which a search walks through for a single
+   *  character, is stored contiguously in breadth first order, followed
+   *  depth first by the sibling trees of each of its middle children.
+   *  Inserting afterwards is allowed but appends nodes out of order. A
+   *  trie mapped by loadFrozen() becomes an ordinary copy on the heap.
+   */
+  void compact() {
+
+      if(root == nullptr) return;
+
+      // the root is always the first node of the arena and stays there
+      vector<uint32_t> order;
+      vector<uint32_t> newIndex(nodes.getNumNodes() + 1, NULL_NODE);
+      vector<uint32_t> siblings(1, 1); // first node of each pending tree
+      order.reserve(nodes.getNumNodes());
+
+      while(!siblings.empty()) {
+          uint32_t first = order.size();
 
-      if(curr->left) deleteTree(curr->left);
+          newIndex[siblings.back()] = order.size() + 1;
+          order.push_back(siblings.back());
+          siblings.pop_back();
+
+          // breadth first through the left/right tree
+          for(uint32_t i = first; i < order.size(); ++i) {
+              TNode* curr = nodes.get(order[i]);
+
+              if(curr->left) {
+                  newIndex[curr->left] = order.size() + 1;
+                  order.push_back(curr->left);
+              }
+
+              if(curr->right) {
+                  newIndex[curr->right] = order.size() + 1;
+                  order.push_back(curr->right);
+              }
+          }
 
-      if(curr->middle) deleteTree(curr->middle);
+          // middle children next, leftmost first
+          for(uint32_t i = order.size(); i-- > first;) {
+              TNode* curr = nodes.get(order[i]);
+              if(curr->middle) siblings.push_back(curr->middle);
+          }
+      }
 
-      if(curr->right) deleteTree(curr->right);
+      // copy in order, renumbering the children
+      TNodeArena packed;
+      for(uint32_t index : order) {
+          TNode* curr = packed.get(packed.alloc(0));
+          *curr = *nodes.get(index);
+          curr->left = newIndex[curr->left];
+          curr->middle = newIndex[curr->middle];
+          curr->right = newIndex[curr->right];
+      }
 
-      delete curr;
+      nodes.swap(packed);
+      root = nodes.get(1);
   }
+
+  /** Replace the trie with the (word, frequency) pairs in words, which are
+   *  sorted in place. Unlike inserting them one at a time in file order,
+   *  which can leave long left/right chains, every left/right tree is
+   *  split at its median word, and the frequency maxima are filled in
+   *  bottom up in the same pass. Of repeated words, the first is kept, as
+   *  insert() would; empty words are skipped.
+   */
+  void build(vector<Word>& words) {
+
+      clear();
+
+      stable_sort(words.begin(), words.end(), TrieOrder());
+
+      // drop repeats and empty words, keeping the first of each
+      size_t numWords = 0;
+      for(size_t i = 0; i < words.size(); ++i) {
+          if(words[i].first.empty()) continue;
+          if(numWords > 0 && words[i].first == words[numWords - 1].first)
+              continue;
+
+          if(i != numWords) words[numWords] = move(words[i]);
+          ++numWords;
+      }
+      words.resize(numWords);
+
+      if(buildRange(words, 0, numWords, 0) != NULL_NODE) root = nodes.get(1);
+
+      compact();
+  }
+
+  /** Number of nodes find() visits looking for word */
+  unsigned int getSearchLength(const string& word) const {
+
+      TNode* curr = root;
+      unsigned int length = 0;
+      size_t index = 0;
+
+      while(curr && index < word.length()) {
+          ++length;
+
+          if(curr->_char == word[index]) {
+              if(++index < word.length()) curr = child(curr->middle);
+          }
+
+          else if(word[index] < curr->_char)
+              curr = child(curr->left);
+
+          else
+              curr = child(curr->right);
+      }
+
+      return length;
+  }
+
+  /** Compact the trie and write it to fileName as a frozen image: a fixed
+   *  header followed by the raw nodes, whose children are already indices
+   *  into the image. Returns false if the file could not be written.
+   */
+  bool freeze(string fileName) {
+
+      compact();
+
+      TrieHeader header;
+      memset(&header, 0, sizeof(header));
+      memcpy(header.magic, TRIE_FILE_MAGIC, sizeof(header.magic));
+      header.version = TRIE_FILE_VERSION;
+      header.nodeBytes = sizeof(TNode);
+      header.numNodes = nodes.getNumNodes() + 1;
+
+      // slot 0 is never read, write it as zeros
+      char unused[sizeof(TNode)];
+      memset(unused, 0, sizeof(unused));
+
+      ofstream file(fileName, ios::binary | ios::trunc);
+      file.write((const char*)&header, sizeof(header));
+      file.write(unused, sizeof(unused));
+      nodes.write(file, 1, nodes.getNumNodes());
+
+      return file.good();
+  }
+
+  /** Replace the trie with the image written by freeze() to fileName,
+   *  mapped and searched in place rather than copied, so only the pages
+   *  queries touch are ever read. The image is trusted; only its header
+   *  is checked. Returns false, leaving the trie as it was, if the file is
+   *  missing, truncated or from an incompatible build.
+   */
+  bool loadFrozen(string fileName) {
+
+      int fd = open(fileName.c_str(), O_RDONLY);
+      if(fd < 0) return false;
+
+      struct stat info;
+      if(fstat(fd, &info) < 0 ||
+              (uint64_t)info.st_size < TRIE_HEADER_BYTES + sizeof(TNode)) {
+          close(fd);
+          return false;
+      }
+
+      uint64_t size = info.st_size;
+      void* mem = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      close(fd);
+
+      if(mem == MAP_FAILED) return false;
+
+      const TrieHeader* header = (const TrieHeader*)mem;
+      if(memcmp(header->magic, TRIE_FILE_MAGIC, sizeof(header->magic)) != 0 ||
+              header->version != TRIE_FILE_VERSION ||
+              header->nodeBytes != sizeof(TNode) || header->numNodes == 0 ||
+              (uint64_t)header->numNodes * sizeof(TNode) >
+                  size - TRIE_HEADER_BYTES) {
+          munmap(mem, size);
+          return false;
+      }
+
+      // start reading the image in while the caller gets going
+      madvise(mem, size, MADV_WILLNEED);
+
+      TNode* first = (TNode*)((char*)mem + TRIE_HEADER_BYTES);
+      nodes.adopt(mem, size, first, header->numNodes);
+      root = header->numNodes > 1 ? nodes.get(1) : nullptr;
+
+      return true;
+  }
+
+  /** Number of nodes in the trie */
+  uint32_t getNumNodes() const { return nodes.getNumNodes(); }
+
+  /** Bytes held by the trie's nodes */
+  uint64_t getNumBytes() const { return nodes.getNumBytes(); }
 };
 
 #endif // DICTIONARYTRIE_HPP
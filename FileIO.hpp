@@ -0,0 +1,169 @@
+/**
+ * Filename:     FileIO.hpp
+ *
+ * Team:         Brandon Olmos (bolmos@ucsd.edu),
+ *               Daryl Nakamoto (dnakamot@ucsd.edu)
+ *
+ * Reference(s): cplusplus.com
+ *               man mmap(2), memchr(3)
+ *
+ * Description:  Low overhead file access for the hot paths. MappedFile maps
+ *               a whole file read-only and walks its lines in place,
+ *               BufferedWriter collects output in a large buffer and writes
+ *               it out in a few big chunks.
+ */
+
+#ifndef FILE_IO_HPP
+#define FILE_IO_HPP
+
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define WRITE_BUFFER_BYTES (1 << 20) // output collected before each write
+
+using namespace std;
+
+/**
+ * Read-only memory mapping of a whole file, with a cursor for reading it
+ * one line at a time without copying.
+ */
+class MappedFile {
+
+private:
+
+    const char* data;
+    uint64_t size;
+    uint64_t cursor; // offset of the next line
+
+    // no copies, the mapping is owned
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+
+public:
+
+    /** Create an unopened mapping */
+    MappedFile() : data(nullptr), size(0), cursor(0) {}
+
+    /** Unmap the file */
+    ~MappedFile() { close(); }
+
+    /** Map fileName. Returns false if it cannot be opened or mapped, or is
+     *  not a regular file (pipes and terminals cannot be mapped).
+     */
+    bool open(const string& fileName) {
+
+        close();
+
+        int fd = ::open(fileName.c_str(), O_RDONLY);
+        if(fd < 0) return false;
+
+        struct stat info;
+        if(fstat(fd, &info) < 0 || !S_ISREG(info.st_mode)) {
+            ::close(fd);
+            return false;
+        }
+
+        // an empty file has nothing to map but is still a valid file
+        size = info.st_size;
+        if(size > 0) {
+            void* mem = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+            if(mem == MAP_FAILED) {
+                ::close(fd);
+                size = 0;
+                return false;
+            }
+
+            // lines are read front to back
+            madvise(mem, size, MADV_SEQUENTIAL);
+            data = (const char*)mem;
+        }
+
+        ::close(fd);
+        return true;
+    }
+
+    /** Unmap the file, if one is mapped */
+    void close() {
+        if(data) munmap((void*)data, size);
+
+        data = nullptr;
+        size = cursor = 0;
+    }
+
+    /** Start of the mapped file */
+    const char* begin() const { return data; }
+
+    /** Size of the mapped file in bytes */
+    uint64_t getSize() const { return size; }
+
+    /** Point line at the next line, without its newline, and store its
+     *  length in len. Returns false at the end of the file. Follows getline:
+     *  a final line without a newline is still returned.
+     */
+    bool nextLine(const char*& line, size_t& len) {
+
+        if(cursor >= size) return false;
+
+        // memchr scans many bytes per step for the newline
+        line = data + cursor;
+        const char* end = (const char*)memchr(line, '\n', size - cursor);
+
+        if(end) {
+            len = end - line;
+            cursor += len + 1;
+        } else {
+            len = size - cursor;
+            cursor = size;
+        }
+
+        return true;
+    }
+};
+
+/**
+ * Collects output in a large buffer and hands it to the stream in big
+ * writes, instead of one write (and flush, with endl) per line.
+ */
+class BufferedWriter {
+
+private:
+
+    ofstream& output;
+    vector<char> buffer;
+
+public:
+
+    /** Create a writer in front of output */
+    BufferedWriter(ofstream& output) : output(output) {
+        buffer.reserve(WRITE_BUFFER_BYTES);
+    }
+
+    /** Write whatever is still buffered */
+    ~BufferedWriter() { flush(); }
+
+    /** Append a line of len bytes and a newline */
+    void writeLine(const char* line, size_t len) {
+
+        if(buffer.size() + len + 1 > WRITE_BUFFER_BYTES) flush();
+
+        buffer.insert(buffer.end(), line, line + len);
+        buffer.push_back('\n');
+    }
+
+    /** Hand the buffered bytes to the stream */
+    void flush() {
+        if(!buffer.empty()) output.write(buffer.data(), buffer.size());
+
+        buffer.clear();
+    }
+};
+
+#endif // FILE_IO_HPP
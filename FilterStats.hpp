@@ -0,0 +1,193 @@
+/**
+ * Filename:     FilterStats.hpp
+ *
+ * Team:         Brandon Olmos (bolmos@ucsd.edu),
+ *               Daryl Nakamoto (dnakamot@ucsd.edu)
+ *
+ * Reference(s): cplusplus.com
+ *               http://hdrhistogram.org
+ *
+ * Description:  Optional instrumentation of filter operations: operation
+ *               and hit counts, and latency histograms of one in
+ *               STATS_SAMPLE_RATE operations. Only compiled in when
+ *               FILTER_STATS is defined (make STATS=1); otherwise the
+ *               STATS_ macros expand to nothing and the filters carry no
+ *               counters.
+ */
+
+#ifndef FILTER_STATS_HPP
+#define FILTER_STATS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <stdint.h>
+
+#define STATS_SAMPLE_RATE 64 // one in this many operations is timed
+#define HIST_SUB_BITS 4      // 16 linear buckets per power of two, ~6% error
+#define HIST_SUB_BUCKETS (1 << HIST_SUB_BITS)
+#define HIST_BUCKETS (HIST_SUB_BUCKETS * 40) // values up to ~2^43 ns
+
+using namespace std;
+
+/**
+ * Log-linear histogram of nanosecond latencies in the style of HdrHistogram:
+ * values below HIST_SUB_BUCKETS get a bucket each, larger ones share
+ * HIST_SUB_BUCKETS buckets per power of two, so every bucket is within
+ * 1/HIST_SUB_BUCKETS of its values. Safe to record into from many threads.
+ */
+class LatencyHistogram {
+
+private:
+
+    atomic<uint64_t> counts[HIST_BUCKETS];
+    atomic<uint64_t> maxValue;
+
+    /** bucket holding value */
+    static unsigned int bucketOf(uint64_t value) {
+
+        if(value < HIST_SUB_BUCKETS) return value;
+
+        // shift that leaves the top HIST_SUB_BITS + 1 bits of value
+        unsigned int shift = 63 - __builtin_clzll(value) - HIST_SUB_BITS;
+        unsigned int bucket = HIST_SUB_BUCKETS * (shift + 1) +
+                              (value >> shift) - HIST_SUB_BUCKETS;
+
+        return bucket < HIST_BUCKETS ? bucket : HIST_BUCKETS - 1;
+    }
+
+    /** smallest value in bucket */
+    static uint64_t lowestIn(unsigned int bucket) {
+
+        if(bucket < HIST_SUB_BUCKETS) return bucket;
+
+        unsigned int shift = bucket / HIST_SUB_BUCKETS - 1;
+        return (uint64_t)(bucket % HIST_SUB_BUCKETS + HIST_SUB_BUCKETS)
+               << shift;
+    }
+
+public:
+
+    /** Create an empty histogram */
+    LatencyHistogram() : maxValue(0) {
+        for(auto& count : counts)
+            count.store(0, memory_order_relaxed);
+    }
+
+    /** Count one operation that took value nanoseconds */
+    void record(uint64_t value) {
+
+        counts[bucketOf(value)].fetch_add(1, memory_order_relaxed);
+
+        uint64_t max = maxValue.load(memory_order_relaxed);
+        while(value > max && !maxValue.compare_exchange_weak(max, value,
+                    memory_order_relaxed));
+    }
+
+    /** Number of recorded values */
+    uint64_t getCount() const {
+
+        uint64_t total = 0;
+        for(auto& count : counts)
+            total += count.load(memory_order_relaxed);
+
+        return total;
+    }
+
+    /** Largest recorded value */
+    uint64_t getMax() const { return maxValue.load(memory_order_relaxed); }
+
+    /** Value below which fraction (0 to 1) of the recorded values fall,
+     *  reported as the lowest value of its bucket
+     */
+    uint64_t percentile(double fraction) const {
+
+        uint64_t total = getCount();
+        uint64_t rank = fraction * total;
+        uint64_t seen = 0;
+
+        for(unsigned int i = 0; i < HIST_BUCKETS; ++i) {
+            seen += counts[i].load(memory_order_relaxed);
+            if(seen > rank) return lowestIn(i);
+        }
+
+        return getMax();
+    }
+
+    /** Write the sample count, percentiles and max as a JSON object */
+    void dump(ostream& out) const {
+        out << "{\"samples\":" << getCount()
+            << ",\"p50\":" << percentile(0.5)
+            << ",\"p90\":" << percentile(0.9)
+            << ",\"p99\":" << percentile(0.99)
+            << ",\"p999\":" << percentile(0.999)
+            << ",\"max\":" << getMax() << "}";
+    }
+};
+
+/** Counts and sampled latencies of one kind of operation */
+struct OpStats {
+
+    atomic<uint64_t> numOps;
+    atomic<uint64_t> numHits; // finds that reported the item present
+    LatencyHistogram latency; // nanoseconds per operation
+
+    OpStats() : numOps(0), numHits(0) {}
+
+    /** Write the counts and latency histogram as a JSON object */
+    void dump(ostream& out) const {
+        out << "{\"count\":" << numOps.load(memory_order_relaxed)
+            << ",\"hits\":" << numHits.load(memory_order_relaxed)
+            << ",\"latency_ns\":";
+        latency.dump(out);
+        out << "}";
+    }
+};
+
+/**
+ * Counts n operations of ops on construction and, if they include a
+ * sampled one, records the time until destruction divided by n.
+ */
+class OpSample {
+
+private:
+
+    OpStats& ops;
+    uint64_t n;
+    bool timed;
+    chrono::steady_clock::time_point start;
+
+public:
+
+    OpSample(OpStats& ops, uint64_t n = 1) : ops(ops), n(n) {
+
+        uint64_t before = ops.numOps.fetch_add(n, memory_order_relaxed);
+
+        // sampled if a multiple of STATS_SAMPLE_RATE is among the n
+        timed = before / STATS_SAMPLE_RATE !=
+                (before + n - 1) / STATS_SAMPLE_RATE ||
+                before % STATS_SAMPLE_RATE == 0;
+        if(timed) start = chrono::steady_clock::now();
+    }
+
+    ~OpSample() {
+        if(!timed || n == 0) return;
+
+        chrono::steady_clock::duration elapsed =
+            chrono::steady_clock::now() - start;
+        ops.latency.record(
+            chrono::duration_cast<chrono::nanoseconds>(elapsed).count() / n);
+    }
+};
+
+#ifdef FILTER_STATS
+#define STATS_OP(ops) OpSample statsSample(ops)
+#define STATS_OPS(ops, n) OpSample statsSample(ops, n)
+#define STATS_HITS(ops, n) (ops).numHits.fetch_add(n, memory_order_relaxed)
+#else
+#define STATS_OP(ops)
+#define STATS_OPS(ops, n)
+#define STATS_HITS(ops, n)
+#endif
+
+#endif // FILTER_STATS_HPP
@@ -0,0 +1,146 @@
+/**
+ * Filename:     FixedBloomFilter.hpp
+ *
+ * Team:         Brandon Olmos (bolmos@ucsd.edu),
+ *               Daryl Nakamoto (dnakamot@ucsd.edu)
+ *
+ * Reference(s): cplusplus.com
+ *               https://github.com/aappleby/smhasher/wiki/MurmurHash3
+ *
+ * Description:  Bloom filter whose size and number of hashes are template
+ *               arguments, for filters whose geometry is fixed at build time.
+ *               The table is an aligned array inside the object and every
+ *               size, shift and probe count is a compile time constant, so
+ *               the probe loop unrolls and positions need no multiply when
+ *               the size is a power of two.
+ */
+
+#ifndef FIXED_BLOOM_FILTER_HPP
+#define FIXED_BLOOM_FILTER_HPP
+
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdint.h>
+#include "BloomFilter.hpp"
+
+#define FIXED_SEED 3       // same seed as BloomFilter, so same positions
+#define FIXED_ALIGN 64     // table starts on a cache line
+
+using namespace std;
+
+/**
+ * Bloom filter of Bits bits probed K times with double hashing. A filter of
+ * the same size and hashes as a DOUBLE_HASH BloomFilter sets the same bits.
+ * The table lives in the object, so allocate large filters with new.
+ */
+template<uint64_t Bits, unsigned int K, class Hash = Murmur3x64Hash>
+class FixedBloomFilter {
+
+    static_assert(Bits >= 64 && Bits % 64 == 0,
+            "table must be a whole number of 64-bit words");
+    static_assert(K >= 1, "at least one hash is needed");
+
+    /** floor(log2(x)) */
+    static constexpr unsigned int log2(uint64_t x) {
+        return x > 1 ? 1 + log2(x / 2) : 0;
+    }
+
+public:
+
+    static constexpr uint64_t NUM_BITS = Bits;
+    static constexpr uint64_t NUM_WORDS = Bits / 64;
+    static constexpr unsigned int NUM_HASHES = K;
+
+    // power of two tables take positions from the top bits of the hash
+    static constexpr bool POW2 = (Bits & (Bits - 1)) == 0;
+    static constexpr unsigned int SHIFT = 64 - log2(Bits);
+
+private:
+
+    // the table of bits, inline so lookups need no pointer load
+    alignas(FIXED_ALIGN) uint64_t table[NUM_WORDS];
+
+    // number of items inserted, duplicates included
+    uint64_t numItems;
+
+    /** map a 64-bit hash onto [0, Bits), as BloomFilter::fastRange does */
+    static uint64_t position(uint64_t hash) {
+        return POW2 ? hash >> SHIFT : BloomFilter::fastRange(hash, Bits);
+    }
+
+public:
+
+    /** Create an empty filter */
+    FixedBloomFilter() : numItems(0) { memset(table, 0, sizeof(table)); }
+
+    /** Allocate on a cache line; plain new only guarantees 16 bytes */
+    static void* operator new(size_t size) {
+        void* mem = nullptr;
+        if(posix_memalign(&mem, FIXED_ALIGN, size)) throw bad_alloc();
+        return mem;
+    }
+
+    static void operator delete(void* mem) { free(mem); }
+
+    /** Insert an item of len bytes into the bloom filter, hashed in place */
+    void insert(const char* item, size_t len) {
+
+        uint64_t output[2];
+        Hash::hash(item, len, FIXED_SEED, output);
+
+        for(unsigned int i = 0; i < K; ++i) {
+            uint64_t pos = position(output[0] + i * output[1]);
+            table[pos >> 6] |= (uint64_t)1 << (pos & 63);
+        }
+
+        ++numItems;
+    }
+
+    /** Determine whether an item of len bytes is in the bloom filter */
+    bool find(const char* item, size_t len) const {
+
+        uint64_t output[2];
+        Hash::hash(item, len, FIXED_SEED, output);
+
+        for(unsigned int i = 0; i < K; ++i) {
+            uint64_t pos = position(output[0] + i * output[1]);
+            if(!((table[pos >> 6] >> (pos & 63)) & 1))
+                return false;
+        }
+
+        return true;
+    }
+
+    /** Insert an item into the bloom filter */
+    void insert(const std::string& item) { insert(item.data(), item.size()); }
+
+    /** Determine whether an item is in the bloom filter */
+    bool find(const std::string& item) const {
+        return find(item.data(), item.size());
+    }
+
+    /** Size of the table in bytes */
+    static constexpr uint64_t getNumBytes() { return Bits / 8; }
+
+    /** Number of bits set per item */
+    static constexpr unsigned int getNumHashes() { return K; }
+
+    /** Number of items inserted, duplicates included */
+    uint64_t getNumItems() const { return numItems; }
+};
+
+// definitions for the constants, needed when they are bound to a reference
+template<uint64_t Bits, unsigned int K, class Hash>
+constexpr uint64_t FixedBloomFilter<Bits, K, Hash>::NUM_BITS;
+template<uint64_t Bits, unsigned int K, class Hash>
+constexpr uint64_t FixedBloomFilter<Bits, K, Hash>::NUM_WORDS;
+template<uint64_t Bits, unsigned int K, class Hash>
+constexpr unsigned int FixedBloomFilter<Bits, K, Hash>::NUM_HASHES;
+template<uint64_t Bits, unsigned int K, class Hash>
+constexpr bool FixedBloomFilter<Bits, K, Hash>::POW2;
+template<uint64_t Bits, unsigned int K, class Hash>
+constexpr unsigned int FixedBloomFilter<Bits, K, Hash>::SHIFT;
+
+#endif // FIXED_BLOOM_FILTER_HPP
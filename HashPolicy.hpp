@@ -0,0 +1,105 @@
+/**
+ * Filename:     HashPolicy.hpp
+ *
+ * Team:         Brandon Olmos (bolmos@ucsd.edu),
+ *               Daryl Nakamoto (dnakamot@ucsd.edu)
+ *
+ * Reference(s): https://github.com/aappleby/smhasher/wiki/MurmurHash3
+ *               https://github.com/wangyi-fudan/wyhash
+ *
+ * Description:  Hash policies a BasicBloomFilter can be instantiated with.
+ *               A policy turns a key and a seed into two 64-bit words, the
+ *               base and the stride of the double hashing probes. Seeded
+ *               probes keep only the second word. ID is stored in saved
+ *               filters so a file is only loaded with the hash it was
+ *               built with.
+ */
+
+#ifndef HASH_POLICY_HPP
+#define HASH_POLICY_HPP
+
+#include <stdint.h>
+#include <cstddef>
+#include "MurmurHash3.h"
+#include "WyHash.h"
+
+#define HASH_LANES 4 // keys hashed together by hash4
+
+/** MurmurHash3_x64_128, both halves of the 128-bit hash. The default. */
+struct Murmur3x64Hash {
+
+    static const uint32_t ID = 0;
+
+    static const char* name() { return "murmur3 x64_128"; }
+
+    static void hash(const char* key, size_t len, uint32_t seed,
+            uint64_t* out) {
+        MurmurHash3_x64_128(key, len, seed, out);
+    }
+
+    /** hash HASH_LANES keys at once into out, two words per key */
+    static void hash4(const char* const* keys, const size_t* lens,
+            uint32_t seed, uint64_t* out) {
+
+        int laneLens[HASH_LANES];
+
+        for(int i = 0; i < HASH_LANES; ++i)
+            laneLens[i] = lens[i];
+
+        MurmurHash3_x64_128_x4((const void* const*)keys, laneLens, seed, out);
+    }
+};
+
+/** MurmurHash3_x86_32. The 32-bit hash is the base and the hash times the
+ *  32-bit golden ratio is the stride (a rotated copy of the hash, as in
+ *  LevelDB, correlates with the base under fastRange and triples the false
+ *  positive rate). Both sit in the high half of their word so fastRange
+ *  spreads them over the table; tables above 4 Gbit can then only reach
+ *  every (tableSize / 2^32)th bit.
+ */
+struct Murmur3x86Hash {
+
+    static const uint32_t ID = 1;
+
+    static const char* name() { return "murmur3 x86_32"; }
+
+    static void hash(const char* key, size_t len, uint32_t seed,
+            uint64_t* out) {
+
+        uint32_t h;
+        MurmurHash3_x86_32(key, len, seed, &h);
+
+        out[0] = (uint64_t)h << 32;
+        out[1] = (uint64_t)(h * 0x9e3779b9u) << 32;
+    }
+
+    static void hash4(const char* const* keys, const size_t* lens,
+            uint32_t seed, uint64_t* out) {
+        for(int i = 0; i < HASH_LANES; ++i)
+            hash(keys[i], lens[i], seed, out + i * 2);
+    }
+};
+
+/** wyhash-style 64-bit hash as the base, remixed into the stride. Fastest
+ *  on short keys, which it reads without a byte loop.
+ */
+struct Wy64Hash {
+
+    static const uint32_t ID = 2;
+
+    static const char* name() { return "wyhash 64"; }
+
+    static void hash(const char* key, size_t len, uint32_t seed,
+            uint64_t* out) {
+        out[0] = WyHash_64(key, len, seed);
+        out[1] = WyHash_mix(out[0], 0x9e3779b97f4a7c15ULL);
+    }
+
+    static void hash4(const char* const* keys, const size_t* lens,
+            uint32_t seed, uint64_t* out) {
+        for(int i = 0; i < HASH_LANES; ++i)
+            hash(keys[i], lens[i], seed, out + i * 2);
+    }
+};
+
+#endif // HASH_POLICY_HPP
@@ -0,0 +1,165 @@
+/**
+ * Filename:     MembershipFilter.cpp
+ *
+ * Team:         Brandon Olmos (bolmos@ucsd.edu),
+ *               Daryl Nakamoto (dnakamot@ucsd.edu)
+ *
+ * Reference(s): cplusplus.com
+ *
+ * Description:  Url file handling shared by every membership filter
+ *               backend, and loading of saved filters of any backend.
+ */
+
+#include "MembershipFilter.hpp"
+#include "BloomFilter.hpp"
+#include "XorFilter.hpp"
+#include "FileIO.hpp"
+#include <cstring>
+
+using namespace std;
+
+/** Determine for each of the n keys whether it is in the filter */
+void MembershipFilter::findBatch(const char* const* keys, const size_t* lens,
+        size_t n, bool* out)
+{
+    for(size_t i = 0; i < n; ++i)
+        out[i] = find(keys[i], lens[i]);
+}
+
+/** Write the size of the filter as a JSON object */
+void MembershipFilter::dumpStats(ostream& out) const {
+    out << "{\"items\":" << getNumItems() << ",\"bytes\":" << getNumBytes()
+        << "}";
+}
+
+/** Read a filter written by any backend's save(), picking the backend from
+ *  the magic at the start of the file
+ */
+MembershipFilter* MembershipFilter::load(string fileName) {
+
+    char magic[8] = {};
+    ifstream file(fileName, ios::binary);
+    file.read(magic, sizeof(magic));
+    file.close();
+
+    // the header names the hash policy, only the matching one loads it
+    if(memcmp(magic, BLOOM_FILE_MAGIC, sizeof(magic)) == 0) {
+        MembershipFilter* filter = BloomFilter::load(fileName);
+
+        if(!filter) filter = BasicBloomFilter<Murmur3x86Hash>::load(fileName);
+        if(!filter) filter = BasicBloomFilter<Wy64Hash>::load(fileName);
+
+        return filter;
+    }
+
+    if(memcmp(magic, XOR_FILE_MAGIC, sizeof(magic)) == 0)
+        return XorFilter::load(fileName);
+
+    return nullptr;
+}
+
+/** insert every line of the file badUrls */
+void MembershipFilter::trainFromFile(string badUrls) {
+
+    MappedFile input;
+    const char* url;
+    size_t len;
+
+    if(input.open(badUrls)) {
+        while(input.nextLine(url, len))
+            insert(url, len);
+    } else {
+        ifstream file(badUrls);
+        string line;
+
+        while(getline(file, line))
+            insert(line);
+    }
+
+    build();
+}
+
+/** read file of urls and write good urls to an output file */
+void MembershipFilter::processURLs(ifstream& file, string goodUrls,
+        ofstream& output, string outputFile, double& numOutput,
+        double& numUrls) {
+
+    MappedFile input;
+    const char* urls[BATCH_SIZE];
+    size_t lens[BATCH_SIZE];
+    bool isBadURL[BATCH_SIZE];
+    size_t numRead;
+
+    // streams that cannot be mapped (pipes) go through getline instead
+    if(!input.open(goodUrls)) {
+        processStream(file, goodUrls, output, outputFile, numOutput, numUrls);
+        return;
+    }
+
+    // scan the mapped file and write predicted good urls to outputFile
+    output.open(outputFile, ios::binary);
+    {
+        BufferedWriter writer(output);
+
+        do {
+            // classify a batch of urls in place, straight from the mapping
+            for(numRead = 0; numRead < BATCH_SIZE; ++numRead) {
+                if(!input.nextLine(urls[numRead], lens[numRead])) break;
+            }
+
+            findBatch(urls, lens, numRead, isBadURL);
+
+            for(size_t i = 0; i < numRead; ++i) {
+                if(!isBadURL[i]) {
+                    writer.writeLine(urls[i], lens[i]);
+                    ++numOutput;
+                }
+            }
+
+            numUrls += numRead;
+        } while(numRead == BATCH_SIZE);
+    }
+
+    output.close();
+}
+
+/** read a stream of urls with getline and write good urls to an output file */
+void MembershipFilter::processStream(ifstream& file, string goodUrls,
+        ofstream& output, string outputFile, double& numOutput,
+        double& numUrls) {
+
+    string urls[BATCH_SIZE];
+    const char* strs[BATCH_SIZE];
+    size_t lens[BATCH_SIZE];
+    bool isBadURL[BATCH_SIZE];
+    size_t numRead;
+
+    // read the file and write predicted good urls to output file, outputFile
+    file.open(goodUrls);
+    output.open(outputFile);
+    do {
+        // read a batch of urls and classify them together
+        for(numRead = 0; numRead < BATCH_SIZE; ++numRead) {
+            if(!getline(file, urls[numRead])) break;
+
+            strs[numRead] = urls[numRead].data();
+            lens[numRead] = urls[numRead].size();
+        }
+
+        findBatch(strs, lens, numRead, isBadURL);
+
+        for(size_t i = 0; i < numRead; ++i) {
+            if(!isBadURL[i]) {
+                output << urls[i] << '\n';
+                ++numOutput;
+            }
+        }
+
+        numUrls += numRead;
+    } while(numRead == BATCH_SIZE);
+
+    // close and clear the buffers for both file so they can be reused later
+    file.close();
+    file.seekg(0, ios::beg);
+    output.close();
+}
@@ -0,0 +1,97 @@
+/**
+ * Filename:     MembershipFilter.hpp
+ *
+ * Team:         Brandon Olmos (bolmos@ucsd.edu),
+ *               Daryl Nakamoto (dnakamot@ucsd.edu)
+ *
+ * Reference(s): cplusplus.com
+ *
+ * Description:  Common interface of the approximate set membership filters
+ *               firewall can classify urls with. Backends differ in space,
+ *               build time and whether items can be added after building.
+ */
+
+#ifndef MEMBERSHIP_FILTER_HPP
+#define MEMBERSHIP_FILTER_HPP
+
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <stdint.h>
+#include <cstddef>
+
+#define BATCH_SIZE 16 // keys looked up together in findBatch and processURLs
+
+using namespace std;
+
+/**
+ * Approximate set membership filter: find never misses an inserted item but
+ * may report a small fraction of other items as present.
+ */
+class MembershipFilter {
+
+public:
+
+    /** Destructor for the filter */
+    virtual ~MembershipFilter() {}
+
+    /** Insert an item of len bytes into the filter */
+    virtual void insert(const char* item, size_t len) = 0;
+
+    /** Determine whether an item of len bytes is in the filter */
+    virtual bool find(const char* item, size_t len) = 0;
+
+    /** Determine for each of the n keys of lens[i] bytes whether it is in the
+     *  filter, storing the answers in out. Backends override this to overlap
+     *  the memory accesses of a batch.
+     */
+    virtual void findBatch(const char* const* keys, const size_t* lens,
+            size_t n, bool* out);
+
+    /** Finish construction after the last insert. Static backends build
+     *  their tables here and find nothing until it has run; trainFromFile
+     *  calls it.
+     */
+    virtual void build() {}
+
+    /** Size of the filter's tables in bytes */
+    virtual uint64_t getNumBytes() const = 0;
+
+    /** Number of items inserted, duplicates included */
+    virtual uint64_t getNumItems() const = 0;
+
+    /** Write the filter to fileName so load() can read it back. Returns false
+     *  if the file could not be written or the backend cannot be saved.
+     */
+    virtual bool save(string fileName) const { return false; }
+
+    /** Write the filter's statistics to out as a JSON object */
+    virtual void dumpStats(ostream& out) const;
+
+    /** Read a filter written by any backend's save(). Returns nullptr if the
+     *  file is missing or not a saved filter. The caller owns the filter.
+     */
+    static MembershipFilter* load(string fileName);
+
+    /** Insert an item into the filter */
+    void insert(const std::string& item) { insert(item.data(), item.size()); }
+
+    /** Determine whether an item is in the filter */
+    bool find(const std::string& item) { return find(item.data(), item.size()); }
+
+    /** insert every line of the file badUrls */
+    void trainFromFile(string badUrls);
+
+    /** read file of urls and write good urls to an output file. Maps the
+     *  file and looks urls up in place; falls back to processStream for
+     *  inputs that cannot be mapped.
+     */
+    void processURLs(ifstream& file, string goodUrls, ofstream& output,
+            string outputFile, double& numOutput, double& numUrls);
+
+    /** read file of urls with getline and write good urls to an output file */
+    void processStream(ifstream& file, string goodUrls, ofstream& output,
+            string outputFile, double& numOutput, double& numUrls);
+};
+
+#endif // MEMBERSHIP_FILTER_HPP
@@ -333,3 +333,237 @@ void MurmurHash3_x64_128 ( const void * key, const int len,
 
 //-----------------------------------------------------------------------------
 
+// Four-key x64_128. Each 256-bit register holds the same hash state
+// variable for four keys, one key per 64-bit lane. AVX2 has no 64-bit
+// multiply; every multiply here is by a constant, so it is built from
+// three 32x32->64 multiplies with the constant's high half precomputed.
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+
+#include <immintrin.h>
+#include <string.h>
+
+#define HAVE_AVX2_KERNEL
+
+#define ROTL64x4(x,r) \
+  _mm256_or_si256(_mm256_slli_epi64(x,r),_mm256_srli_epi64(x,64-(r)))
+
+// a * c where chi holds the high 32 bits of c
+
+__attribute__((target("avx2")))
+static inline __m256i mulc64x4 ( __m256i a, __m256i c, __m256i chi )
+{
+  __m256i lo = _mm256_mul_epu32(a,c);
+  __m256i cross = _mm256_add_epi64(
+      _mm256_mul_epu32(_mm256_srli_epi64(a,32),c),
+      _mm256_mul_epu32(a,chi));
+
+  return _mm256_add_epi64(lo,_mm256_slli_epi64(cross,32));
+}
+
+// hi in the upper 128 bits, lo in the lower (_mm256_set_m128i is missing
+// from older compilers)
+
+#define SET128x2(hi,lo) \
+  _mm256_inserti128_si256(_mm256_castsi128_si256(lo),hi,1)
+
+#define MULC64x4(a,c) \
+  mulc64x4(a,_mm256_set1_epi64x(c),_mm256_set1_epi64x((c) >> 32))
+
+__attribute__((target("avx2")))
+static inline __m256i fmix64x4 ( __m256i k )
+{
+  k = _mm256_xor_si256(k,_mm256_srli_epi64(k,33));
+  k = MULC64x4(k,BIG_CONSTANT(0xff51afd7ed558ccd));
+  k = _mm256_xor_si256(k,_mm256_srli_epi64(k,33));
+  k = MULC64x4(k,BIG_CONSTANT(0xc4ceb9fe1a85ec53));
+  k = _mm256_xor_si256(k,_mm256_srli_epi64(k,33));
+
+  return k;
+}
+
+// load 16-byte block i of a key, or zeros past its last block
+
+__attribute__((target("avx2")))
+static inline __m128i loadblock ( const uint8_t * data, int nblocks, int i )
+{
+  if(i < nblocks) return _mm_loadu_si128((const __m128i*)(data + i*16));
+  return _mm_setzero_si128();
+}
+
+// load the len & 15 tail bytes of a key, zero padded to 16 bytes. Keys of
+// at least one block reread their last 16 bytes and shift the tail down,
+// which avoids a variable-length copy.
+
+static const int8_t tailshuffle[32] =
+{
+   0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
+__attribute__((target("avx2")))
+static inline __m128i loadtail ( const uint8_t * data, int len )
+{
+  int rem = len & 15;
+
+  if(len >= 16)
+  {
+    __m128i last = _mm_loadu_si128((const __m128i*)(data + len - 16));
+    __m128i mask = _mm_loadu_si128((const __m128i*)(tailshuffle + 16 - rem));
+    return _mm_shuffle_epi8(last,mask);
+  }
+
+  uint8_t tail[16] = {0};
+  memcpy(tail,data,rem);
+  return _mm_loadu_si128((const __m128i*)tail);
+}
+
+__attribute__((target("avx2")))
+static void MurmurHash3_x64_128_x4_avx2 ( const void * const * keys,
+                                          const int * lens,
+                                          uint32_t seed, void * out )
+{
+  const uint8_t * data[4];
+  int nblocks[4];
+
+  for(int j = 0; j < 4; j++)
+  {
+    data[j] = (const uint8_t*)keys[j];
+    nblocks[j] = lens[j] / 16;
+  }
+
+  int minblocks = nblocks[0];
+  int maxblocks = nblocks[0];
+
+  for(int j = 1; j < 4; j++)
+  {
+    if(nblocks[j] < minblocks) minblocks = nblocks[j];
+    if(nblocks[j] > maxblocks) maxblocks = nblocks[j];
+  }
+
+  __m256i h1 = _mm256_set1_epi64x(seed);
+  __m256i h2 = _mm256_set1_epi64x(seed);
+
+  const uint64_t c1 = BIG_CONSTANT(0x87c37b91114253d5);
+  const uint64_t c2 = BIG_CONSTANT(0x4cf5ad432745937f);
+  const __m256i n1 = _mm256_set1_epi64x(0x52dce729);
+  const __m256i n2 = _mm256_set1_epi64x(0x38495ab5);
+  const __m256i lanelen = _mm256_set_epi64x(lens[3],lens[2],lens[1],lens[0]);
+  const __m256i laneblocks = _mm256_srli_epi64(lanelen,4);
+
+  //----------
+  // body, in lockstep while every key has blocks left, then masked so
+  // shorter keys keep their state
+
+  for(int i = 0; i < maxblocks; i++)
+  {
+    // transpose the four 16-byte blocks into first and second words
+    __m256i b02 = SET128x2(loadblock(data[2],nblocks[2],i),
+                           loadblock(data[0],nblocks[0],i));
+    __m256i b13 = SET128x2(loadblock(data[3],nblocks[3],i),
+                           loadblock(data[1],nblocks[1],i));
+    __m256i k1 = _mm256_unpacklo_epi64(b02,b13);
+    __m256i k2 = _mm256_unpackhi_epi64(b02,b13);
+
+    __m256i g1 = h1;
+    __m256i g2 = h2;
+
+    k1 = MULC64x4(k1,c1); k1 = ROTL64x4(k1,31); k1 = MULC64x4(k1,c2);
+    g1 = _mm256_xor_si256(g1,k1);
+
+    g1 = ROTL64x4(g1,27); g1 = _mm256_add_epi64(g1,g2);
+    g1 = _mm256_add_epi64(_mm256_add_epi64(_mm256_slli_epi64(g1,2),g1),n1);
+
+    k2 = MULC64x4(k2,c2); k2 = ROTL64x4(k2,33); k2 = MULC64x4(k2,c1);
+    g2 = _mm256_xor_si256(g2,k2);
+
+    g2 = ROTL64x4(g2,31); g2 = _mm256_add_epi64(g2,g1);
+    g2 = _mm256_add_epi64(_mm256_add_epi64(_mm256_slli_epi64(g2,2),g2),n2);
+
+    if(i < minblocks)
+    {
+      h1 = g1;
+      h2 = g2;
+    }
+    else
+    {
+      __m256i active = _mm256_cmpgt_epi64(laneblocks,_mm256_set1_epi64x(i));
+      h1 = _mm256_blendv_epi8(h1,g1,active);
+      h2 = _mm256_blendv_epi8(h2,g2,active);
+    }
+  }
+
+  //----------
+  // tail. Mixing a zero tail word leaves h unchanged, so keys whose tail
+  // is shorter than 9 bytes (or empty) need no mask.
+
+  __m256i t02 = SET128x2(loadtail(data[2],lens[2]),
+                         loadtail(data[0],lens[0]));
+  __m256i t13 = SET128x2(loadtail(data[3],lens[3]),
+                         loadtail(data[1],lens[1]));
+  __m256i k1 = _mm256_unpacklo_epi64(t02,t13);
+  __m256i k2 = _mm256_unpackhi_epi64(t02,t13);
+
+  k2 = MULC64x4(k2,c2); k2 = ROTL64x4(k2,33); k2 = MULC64x4(k2,c1);
+  h2 = _mm256_xor_si256(h2,k2);
+
+  k1 = MULC64x4(k1,c1); k1 = ROTL64x4(k1,31); k1 = MULC64x4(k1,c2);
+  h1 = _mm256_xor_si256(h1,k1);
+
+  //----------
+  // finalization
+
+  h1 = _mm256_xor_si256(h1,lanelen); h2 = _mm256_xor_si256(h2,lanelen);
+
+  h1 = _mm256_add_epi64(h1,h2);
+  h2 = _mm256_add_epi64(h2,h1);
+
+  h1 = fmix64x4(h1);
+  h2 = fmix64x4(h2);
+
+  h1 = _mm256_add_epi64(h1,h2);
+  h2 = _mm256_add_epi64(h2,h1);
+
+  // interleave to key order: h1 and h2 of key 0, then key 1, ...
+
+  __m256i lo = _mm256_unpacklo_epi64(h1,h2);  // keys 0 and 2
+  __m256i hi = _mm256_unpackhi_epi64(h1,h2);  // keys 1 and 3
+
+  _mm256_storeu_si256((__m256i*)out,_mm256_permute2x128_si256(lo,hi,0x20));
+  _mm256_storeu_si256((__m256i*)out + 1,
+                      _mm256_permute2x128_si256(lo,hi,0x31));
+}
+
+#endif // HAVE_AVX2_KERNEL
+
+static void MurmurHash3_x64_128_x4_scalar ( const void * const * keys,
+                                            const int * lens,
+                                            uint32_t seed, void * out )
+{
+  for(int j = 0; j < 4; j++)
+    MurmurHash3_x64_128(keys[j],lens[j],seed,(uint64_t*)out + j*2);
+}
+
+typedef void (*hash_x4_fn)( const void * const *, const int *, uint32_t,
+                            void * );
+
+// the vector kernel only pays off when it is compiled with optimisation: at
+// -O0 every lane is spilled to the stack and it loses to the scalar loop
+
+static hash_x4_fn select_x64_128_x4 ( )
+{
+#if defined(HAVE_AVX2_KERNEL) && defined(__OPTIMIZE__)
+  if(__builtin_cpu_supports("avx2")) return MurmurHash3_x64_128_x4_avx2;
+#endif
+  return MurmurHash3_x64_128_x4_scalar;
+}
+
+void MurmurHash3_x64_128_x4 ( const void * const * keys, const int * lens,
+                              uint32_t seed, void * out )
+{
+  static const hash_x4_fn hash = select_x64_128_x4();
+
+  hash(keys,lens,seed,out);
+}
+
+//-----------------------------------------------------------------------------
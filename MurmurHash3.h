@@ -32,6 +32,13 @@ void MurmurHash3_x86_128 ( const void * key, int len, uint32_t seed, void * out
 
 void MurmurHash3_x64_128 ( const void * key, int len, uint32_t seed, void * out );
 
+// Hashes four keys at once, giving the same results as four calls to
+// MurmurHash3_x64_128. out receives the four 128-bit hashes in key order.
+// Uses AVX2 lanes when the CPU supports them.
+
+void MurmurHash3_x64_128_x4 ( const void * const * keys, const int * lens,
+                              uint32_t seed, void * out );
+
 //-----------------------------------------------------------------------------
 
 #endif // _MURMURHASH3_H_
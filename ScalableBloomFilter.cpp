@@ -0,0 +1,79 @@
+/**
+ * Filename:     ScalableBloomFilter.cpp
+ *
+ * Team:         Brandon Olmos (bolmos@ucsd.edu),
+ *               Daryl Nakamoto (dnakamot@ucsd.edu)
+ *
+ * Reference(s): cplusplus.com
+ *               Almeida et al., Scalable Bloom Filters (2007)
+ *
+ * Description:  Scalable bloom filter built from a chain of BloomFilters.
+ *               Inserts go to the newest sub-filter; lookups check them all,
+ *               newest first since it holds the most items.
+ */
+
+#include "ScalableBloomFilter.hpp"
+
+using namespace std;
+
+/** Create a scalable bloom filter with overall false positive rate at most
+ *  fpRate, starting with room for initialCapacity items
+ */
+ScalableBloomFilter::ScalableBloomFilter(double fpRate,
+        uint64_t initialCapacity, double growth, double tightening)
+    : capacity(initialCapacity ? initialCapacity : 1), numInNewest(0),
+      numItems(0), fpRate(fpRate * (1 - tightening)), growth(growth),
+      tightening(tightening)
+{
+    addFilter();
+}
+
+/** Destructor for the scalable bloom filter */
+ScalableBloomFilter::~ScalableBloomFilter()
+{
+    for(BloomFilter* filter : filters)
+        delete filter;
+}
+
+/** chain on a sub-filter for capacity items at error rate fpRate */
+void ScalableBloomFilter::addFilter() {
+    filters.push_back(BloomFilter::forRate(capacity, fpRate));
+    numInNewest = 0;
+}
+
+/** Insert an item of len bytes, growing the filter if it is full */
+void ScalableBloomFilter::insert(const char* item, size_t len)
+{
+    // the next sub-filter is bigger and stricter than the full one
+    if(numInNewest >= capacity) {
+        capacity = capacity * growth;
+        fpRate *= tightening;
+        addFilter();
+    }
+
+    filters.back()->insert(item, len);
+    ++numInNewest;
+    ++numItems;
+}
+
+/** Determine whether an item of len bytes is in any sub-filter */
+bool ScalableBloomFilter::find(const char* item, size_t len)
+{
+    for(size_t i = filters.size(); i-- > 0;) {
+        if(filters[i]->find(item, len))
+            return true;
+    }
+
+    return false;
+}
+
+/** Total size of the sub-filter tables in bytes */
+uint64_t ScalableBloomFilter::getNumBytes() const {
+
+    uint64_t numBytes = 0;
+
+    for(BloomFilter* filter : filters)
+        numBytes += filter->getNumBytes();
+
+    return numBytes;
+}
@@ -0,0 +1,95 @@
+/**
+ * Filename:     ScalableBloomFilter.hpp
+ *
+ * Team:         Brandon Olmos (bolmos@ucsd.edu),
+ *               Daryl Nakamoto (dnakamot@ucsd.edu)
+ *
+ * Reference(s): cplusplus.com
+ *               Almeida et al., Scalable Bloom Filters (2007)
+ *
+ * Description:  Bloom filter that grows as items arrive. New sub-filters
+ *               are chained on as the newest one fills up, each larger and
+ *               with a tighter error rate than the last, so the overall
+ *               false positive rate stays bounded without knowing the item
+ *               count upfront.
+ */
+
+#ifndef SCALABLE_BLOOM_FILTER_HPP
+#define SCALABLE_BLOOM_FILTER_HPP
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "BloomFilter.hpp"
+
+#define SCALABLE_CAPACITY (1 << 16) // items in the first sub-filter
+#define SCALABLE_GROWTH 2           // capacity ratio of consecutive filters
+#define SCALABLE_TIGHTENING 0.5     // error ratio of consecutive filters
+
+using namespace std;
+
+/**
+ * Chain of BloomFilters of geometrically growing capacity. Sub-filter i
+ * holds capacity * growth^i items at error rate p0 * tightening^i, where
+ * p0 = fpRate * (1 - tightening), so the rates sum to at most fpRate.
+ * There is no file format for the chain; save() always returns false.
+ */
+class ScalableBloomFilter : public MembershipFilter {
+
+private:
+
+    vector<BloomFilter*> filters;
+
+    // items the newest sub-filter may take before the next one is added
+    uint64_t capacity;
+    uint64_t numInNewest;
+    uint64_t numItems;
+
+    // error rate of the newest sub-filter
+    double fpRate;
+
+    double growth;
+    double tightening;
+
+    /** chain on a sub-filter for capacity items at error rate fpRate */
+    void addFilter();
+
+    // no copies, the sub-filters are owned
+    ScalableBloomFilter(const ScalableBloomFilter&);
+    ScalableBloomFilter& operator=(const ScalableBloomFilter&);
+
+public:
+
+    /** Destructor for the scalable bloom filter */
+    ~ScalableBloomFilter() override;
+
+    /** Create a scalable bloom filter with overall false positive rate at
+     *  most fpRate, starting with room for initialCapacity items
+     */
+    ScalableBloomFilter(double fpRate,
+            uint64_t initialCapacity = SCALABLE_CAPACITY,
+            double growth = SCALABLE_GROWTH,
+            double tightening = SCALABLE_TIGHTENING);
+
+    /** Insert an item of len bytes, growing the filter if it is full */
+    void insert(const char* item, size_t len) override;
+
+    /** Determine whether an item of len bytes is in any sub-filter */
+    bool find(const char* item, size_t len) override;
+
+    /** Insert an item into the bloom filter */
+    void insert(const std::string& item) { insert(item.data(), item.size()); }
+
+    /** Determine whether an item is in the bloom filter */
+    bool find(const std::string& item) { return find(item.data(), item.size()); }
+
+    /** Total size of the sub-filter tables in bytes */
+    uint64_t getNumBytes() const override;
+
+    /** Number of items inserted */
+    uint64_t getNumItems() const override { return numItems; }
+
+    /** Number of sub-filters in the chain */
+    size_t getNumFilters() const { return filters.size(); }
+};
+#endif // SCALABLE_BLOOM_FILTER_HPP
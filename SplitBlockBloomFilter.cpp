@@ -0,0 +1,173 @@
+/**
+ * Filename:     SplitBlockBloomFilter.cpp
+ *
+ * Team:         Brandon Olmos (bolmos@ucsd.edu),
+ *               Daryl Nakamoto (dnakamot@ucsd.edu)
+ *
+ * Reference(s): cplusplus.com
+ *               https://github.com/aappleby/smhasher/wiki/MurmurHash3
+ *               Apache Parquet split block bloom filter specification
+ *
+ * Description:  Split block bloom filter. The first half of a MurmurHash3
+ *               call picks the block, the low 32 bits of the second half are
+ *               multiplied by a per-lane salt and the top 5 bits of each
+ *               product select the bit to set in that lane.
+ */
+
+#include "SplitBlockBloomFilter.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAVE_AVX2_KERNEL
+#endif
+
+#define SEED 3
+#define LANE_SHIFT 27 // keep the top 5 bits: a bit index within 32 bits
+
+using namespace std;
+
+// odd multipliers, one per lane, from the Parquet specification
+static const uint32_t SALT[SPLIT_BLOCK_LANES] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+};
+
+/** set the bit of key in every lane of block */
+static void insertBlockScalar(uint32_t* block, uint32_t key) {
+    for(int i = 0; i < SPLIT_BLOCK_LANES; ++i)
+        block[i] |= (uint32_t)1 << ((key * SALT[i]) >> LANE_SHIFT);
+}
+
+/** check that the bit of key is set in every lane of block */
+static bool findBlockScalar(const uint32_t* block, uint32_t key) {
+    for(int i = 0; i < SPLIT_BLOCK_LANES; ++i) {
+        if(!(block[i] & ((uint32_t)1 << ((key * SALT[i]) >> LANE_SHIFT))))
+            return false;
+    }
+
+    return true;
+}
+
+#ifdef HAVE_AVX2_KERNEL
+
+/** one bit per lane: 1 << ((key * SALT[i]) >> 27) for all lanes at once */
+__attribute__((target("avx2")))
+static inline __m256i makeMask(uint32_t key) {
+    __m256i salt = _mm256_loadu_si256((const __m256i*)SALT);
+    __m256i prod = _mm256_mullo_epi32(_mm256_set1_epi32(key), salt);
+
+    return _mm256_sllv_epi32(_mm256_set1_epi32(1),
+                             _mm256_srli_epi32(prod, LANE_SHIFT));
+}
+
+/** set the bit of key in every lane of block */
+__attribute__((target("avx2")))
+static void insertBlockAVX2(uint32_t* block, uint32_t key) {
+    __m256i* vblock = (__m256i*)block;
+
+    _mm256_store_si256(vblock,
+            _mm256_or_si256(_mm256_load_si256(vblock), makeMask(key)));
+}
+
+/** check that the bit of key is set in every lane of block */
+__attribute__((target("avx2")))
+static bool findBlockAVX2(const uint32_t* block, uint32_t key) {
+
+    // testc is true when every bit of the mask is also set in the block
+    return _mm256_testc_si256(_mm256_load_si256((const __m256i*)block),
+                              makeMask(key));
+}
+
+#endif // HAVE_AVX2_KERNEL
+
+/** Whether the running CPU supports the AVX2 kernel */
+bool SplitBlockBloomFilter::hasAVX2() {
+#ifdef HAVE_AVX2_KERNEL
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+/** Create a new split block bloom filter with at least numBytes bytes */
+SplitBlockBloomFilter::SplitBlockBloomFilter(uint64_t numBytes, bool useSIMD)
+{
+    // round up to whole blocks
+    numBlocks = (numBytes + SPLIT_BLOCK_BYTES - 1) / SPLIT_BLOCK_BYTES;
+    if(numBlocks == 0) numBlocks = 1;
+
+    void* mem = nullptr;
+    if(posix_memalign(&mem, SPLIT_BLOCK_BYTES, numBlocks * SPLIT_BLOCK_BYTES))
+        throw bad_alloc();
+
+    table = (uint32_t*)mem;
+
+    // set all bits in table to 0
+    memset(table, 0, numBlocks * SPLIT_BLOCK_BYTES);
+
+    // pick the block kernels for this CPU
+    insertBlock = insertBlockScalar;
+    findBlock = findBlockScalar;
+
+#ifdef HAVE_AVX2_KERNEL
+    if(useSIMD && hasAVX2()) {
+        insertBlock = insertBlockAVX2;
+        findBlock = findBlockAVX2;
+    }
+#endif
+}
+
+/** Create a split block bloom filter sized to hold numItems at roughly false
+ *  positive rate fpRate
+ */
+SplitBlockBloomFilter* SplitBlockBloomFilter::forRate(uint64_t numItems,
+        double fpRate) {
+
+    return new SplitBlockBloomFilter(
+            BloomFilter::optimalNumBytes(numItems, fpRate));
+}
+
+/** Destructor for the split block bloom filter */
+SplitBlockBloomFilter::~SplitBlockBloomFilter()
+{
+    free(table);
+}
+
+/** Whether the AVX2 kernel is in use */
+bool SplitBlockBloomFilter::usesSIMD() const {
+    return findBlock != findBlockScalar;
+}
+
+/** hash str, return its block and store the key for its lane bits */
+uint32_t* SplitBlockBloomFilter::getBlock(const char* str, size_t len,
+        uint32_t& key) {
+
+    // hold the hash value returned from hash function
+    uint64_t output[2];
+
+    MurmurHash3_x64_128(str, len, SEED, output);
+    key = output[1];
+
+    return table + (output[0] % numBlocks) * SPLIT_BLOCK_LANES;
+}
+
+/** Insert an item of len bytes into the bloom filter, hashed in place */
+void SplitBlockBloomFilter::insert(const char* item, size_t len)
+{
+    uint32_t key;
+    uint32_t* block = getBlock(item, len, key);
+
+    insertBlock(block, key);
+}
+
+/** Determine whether an item of len bytes is in the bloom filter */
+bool SplitBlockBloomFilter::find(const char* item, size_t len)
+{
+    uint32_t key;
+    uint32_t* block = getBlock(item, len, key);
+
+    return findBlock(block, key);
+}
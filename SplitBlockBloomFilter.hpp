@@ -0,0 +1,90 @@
+/**
+ * Filename:     SplitBlockBloomFilter.hpp
+ *
+ * Team:         Brandon Olmos (bolmos@ucsd.edu),
+ *               Daryl Nakamoto (dnakamot@ucsd.edu)
+ *
+ * Reference(s): cplusplus.com
+ *               https://github.com/aappleby/smhasher/wiki/MurmurHash3
+ *               Apache Parquet split block bloom filter specification
+ *
+ * Description:  Split block bloom filter. Items live in a single 256-bit
+ *               block and set exactly one bit in each of its eight 32-bit
+ *               lanes, so a block can be set or tested with a few AVX2
+ *               instructions.
+ */
+
+#ifndef SPLIT_BLOCK_BLOOM_FILTER_HPP
+#define SPLIT_BLOCK_BLOOM_FILTER_HPP
+
+#include <string>
+#include <stdint.h>
+#include "BloomFilter.hpp"
+
+#define SPLIT_BLOCK_BYTES 32 // 256-bit block
+#define SPLIT_BLOCK_LANES 8  // 32-bit lanes per block, one bit set in each
+
+using namespace std;
+
+/**
+ * Bloom filter made of 256-bit blocks with 8 probes per item, one per 32-bit
+ * lane. Uses AVX2 when the CPU supports it and a scalar kernel otherwise.
+ */
+class SplitBlockBloomFilter {
+
+private:
+
+    // table of 32-bit lanes, aligned to a block
+    uint32_t* table;
+    uint64_t numBlocks;
+
+    // block kernels chosen at construction from the CPU features
+    void (*insertBlock)(uint32_t* block, uint32_t key);
+    bool (*findBlock)(const uint32_t* block, uint32_t key);
+
+    /** hash str, return its block and store the key for its lane bits */
+    uint32_t* getBlock(const char* str, size_t len, uint32_t& key);
+
+    // no copies, the table is owned
+    SplitBlockBloomFilter(const SplitBlockBloomFilter&);
+    SplitBlockBloomFilter& operator=(const SplitBlockBloomFilter&);
+
+public:
+
+    /** Destructor for the split block bloom filter */
+    ~SplitBlockBloomFilter();
+
+    /** Create a new split block bloom filter with at least numBytes bytes.
+     *  useSIMD false forces the scalar kernel even if AVX2 is available.
+     */
+    SplitBlockBloomFilter(uint64_t numBytes, bool useSIMD = true);
+
+    /** Create a split block bloom filter sized to hold numItems at roughly
+     *  false positive rate fpRate. A factory, like BloomFilter::forRate(),
+     *  so (numBytes, 0) cannot be taken for a rate. The caller owns the
+     *  returned filter.
+     */
+    static SplitBlockBloomFilter* forRate(uint64_t numItems, double fpRate);
+
+    /** Insert an item of len bytes into the bloom filter, hashed in place */
+    void insert(const char* item, size_t len);
+
+    /** Determine whether an item of len bytes is in the bloom filter */
+    bool find(const char* item, size_t len);
+
+    /** Insert an item into the bloom filter */
+    void insert(const std::string& item) { insert(item.data(), item.size()); }
+
+    /** Determine whether an item is in the bloom filter */
+    bool find(const std::string& item) { return find(item.data(), item.size()); }
+
+    /** Size of the table in bytes */
+    uint64_t getNumBytes() const { return numBlocks * SPLIT_BLOCK_BYTES; }
+
+    /** Whether the AVX2 kernel is in use */
+    bool usesSIMD() const;
+
+    /** Whether the running CPU supports the AVX2 kernel */
+    static bool hasAVX2();
+};
+#endif // SPLIT_BLOCK_BLOOM_FILTER_HPP
@@ -7,12 +7,28 @@
  * Reference(s): cplusplus.com
  *
  * Description:  Node class for Dictionary. Used for ternery trie to hold
- *               a char in word and frequency of word.
+ *               a char in word and frequency of word. Nodes live in a
+ *               TNodeArena owned by the trie and refer to their children
+ *               by 32-bit arena index instead of by pointer, which with a
+ *               single subtree maximum keeps a node to 24 bytes.
  */
 
 #ifndef TNODE_HPP
 #define TNODE_HPP
 
+#include <cstdlib>
+#include <cstring> // memset()
+#include <new>
+#include <ostream>
+#include <stdexcept>
+#include <utility> // swap()
+#include <vector>
+#include <stdint.h>
+#include <sys/mman.h>
+
+#define NULL_NODE 0        // index meaning no child; arena slot 0 is unused
+#define SLAB_BITS 16       // 2^16 nodes per arena slab
+#define SLAB_NODES (1 << SLAB_BITS)
 
 using namespace std;
 
@@ -20,28 +36,168 @@ class TNode {
 
 public:
 
-    TNode* left;
-    TNode* right;
-    TNode* middle;
-    char _char;
+    uint32_t left;   // arena index of the children, NULL_NODE if none
+    uint32_t right;
+    uint32_t middle;
     int freq;
-    int fmid;   // most frequent word that went down the middle child
-    int fright; // most frequent word that went down the right child
-    int fleft;  // most frequent word that went down the left child
+    int fmax;   // most frequent word in the subtree rooted at this node
+    char _char;
 
     /** Default constructor for TNode*/
     TNode() {
-        left = right = middle = nullptr;
+        left = right = middle = NULL_NODE;
         freq = 0;
-        fmid = fright = fleft  = 0;
+        fmax = 0;
     }
 
     /** Make a new TNode with char c*/
     TNode(char& c) {
-        left = right = middle = nullptr;
+        left = right = middle = NULL_NODE;
         freq = 0;
         _char = c;
-        fmid = fright = fleft = 0;
+        fmax = 0;
+    }
+};
+
+/**
+ * Bump allocator for the nodes of one trie. Nodes are carved in order out of
+ * slabs of SLAB_NODES nodes that never move, so a node's address is stable
+ * and its index is all a parent has to store. Nodes are never freed one at
+ * a time; the whole arena is released at once, a slab at a time. An arena
+ * can also be laid over a read-only mapping of nodes written out by
+ * DictionaryTrie::freeze(), in which case it cannot allocate.
+ */
+class TNodeArena {
+
+private:
+
+    vector<TNode*> slabs;
+    uint32_t numNodes; // including the unused slot 0
+
+    // mapping the nodes live in when laid over one by adopt(), else nullptr
+    void* mapping;
+    uint64_t mappingSize;
+
+    // copies would free the same slabs twice
+    TNodeArena(const TNodeArena&);
+    TNodeArena& operator=(const TNodeArena&);
+
+public:
+
+    /** Create an empty arena */
+    TNodeArena() : numNodes(1), mapping(nullptr), mappingSize(0) {}
+
+    /** Release every node */
+    ~TNodeArena() { clear(); }
+
+    /** Exchange the nodes of this arena and other */
+    void swap(TNodeArena& other) {
+        slabs.swap(other.slabs);
+        std::swap(numNodes, other.numNodes);
+        std::swap(mapping, other.mapping);
+        std::swap(mappingSize, other.mappingSize);
+    }
+
+    /** Release every node and take over the mapping mem of size bytes,
+     *  whose count nodes (slot 0 included) start at first. The arena unmaps
+     *  it when cleared.
+     */
+    void adopt(void* mem, uint64_t size, TNode* first, uint32_t count) {
+
+        clear();
+
+        // slabs are just windows of SLAB_NODES nodes into the mapping
+        for(uint64_t i = 0; i < count; i += SLAB_NODES)
+            slabs.push_back(first + i);
+
+        numNodes = count;
+        mapping = mem;
+        mappingSize = size;
+    }
+
+    /** Whether the nodes are a read-only mapping that cannot grow */
+    bool isMapped() const { return mapping != nullptr; }
+
+    /** Make a new node holding c and return its index. The arena must not
+     *  be mapped. Throws length_error once the 32-bit indices run out.
+     */
+    uint32_t alloc(char c) {
+
+        // numNodes would wrap to 0 and hand out NULL_NODE as a real node
+        if(numNodes == UINT32_MAX)
+            throw length_error("TNodeArena: out of 32-bit node indices");
+
+        if(numNodes >> SLAB_BITS == slabs.size()) {
+            void* slab = malloc(SLAB_NODES * sizeof(TNode));
+            if(!slab) throw bad_alloc();
+            slabs.push_back((TNode*)slab);
+        }
+
+        uint32_t index = numNodes++;
+        new(get(index)) TNode(c);
+
+        return index;
+    }
+
+    /** Node at index, which must have come from alloc */
+    TNode* get(uint32_t index) const {
+        return slabs[index >> SLAB_BITS] + (index & (SLAB_NODES - 1));
+    }
+
+    /** Release every node at once. TNode has nothing to destroy, so this is
+     *  one free per slab.
+     */
+    void clear() {
+        if(mapping)
+            munmap(mapping, mappingSize);
+        else
+            for(TNode* slab : slabs)
+                free(slab);
+
+        slabs.clear();
+        numNodes = 1;
+        mapping = nullptr;
+        mappingSize = 0;
+    }
+
+    /** Number of nodes allocated */
+    uint32_t getNumNodes() const { return numNodes - 1; }
+
+    /** Bytes held by the slabs, or by the mapping */
+    uint64_t getNumBytes() const {
+        if(mapping) return mappingSize;
+
+        return (uint64_t)slabs.size() * SLAB_NODES * sizeof(TNode);
+    }
+
+    /** Write count nodes starting at index first to file. The nodes are
+     *  copied field by field into a zeroed buffer first, so the padding
+     *  after _char goes out as zeros instead of whatever the slab held.
+     */
+    void write(ostream& file, uint32_t first, uint32_t count) const {
+
+        vector<TNode> buffer(count < SLAB_NODES ? count : SLAB_NODES);
+        memset((void*)buffer.data(), 0, buffer.size() * sizeof(TNode));
+
+        // a slab at a time, nodes within a slab are contiguous
+        while(count > 0) {
+            uint32_t run = SLAB_NODES - (first & (SLAB_NODES - 1));
+            if(run > count) run = count;
+
+            const TNode* nodes = get(first);
+            for(uint32_t i = 0; i < run; ++i) {
+                buffer[i].left = nodes[i].left;
+                buffer[i].right = nodes[i].right;
+                buffer[i].middle = nodes[i].middle;
+                buffer[i].freq = nodes[i].freq;
+                buffer[i].fmax = nodes[i].fmax;
+                buffer[i]._char = nodes[i]._char;
+            }
+
+            file.write((const char*)buffer.data(), run * sizeof(TNode));
+            first += run;
+            count -= run;
+        }
     }
 };
 
@@ -0,0 +1,122 @@
+//-----------------------------------------------------------------------------
+// wyhash-style 64-bit hash, following the structure of wyhash final v4 by
+// Wang Yi (https://github.com/wangyi-fudan/wyhash, public domain).
+//
+// Short keys (up to 16 bytes) are read with two overlapping loads from each
+// end, so there is no per-byte tail loop. Longer keys go through one 16-byte
+// lane, or three independent 16-byte lanes above 48 bytes.
+
+#include "WyHash.h"
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+// wyhash's default secret
+
+static const uint64_t secret[4] =
+{
+  0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL,
+  0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL
+};
+
+//-----------------------------------------------------------------------------
+// Unaligned little-endian reads
+
+static inline uint64_t read64 ( const uint8_t * p )
+{
+  uint64_t v;
+  memcpy(&v,p,8);
+  return v;
+}
+
+static inline uint64_t read32 ( const uint8_t * p )
+{
+  uint32_t v;
+  memcpy(&v,p,4);
+  return v;
+}
+
+// 1 to 3 bytes: first, middle and last byte
+
+static inline uint64_t read3 ( const uint8_t * p, int k )
+{
+  return ((uint64_t)p[0] << 16) | ((uint64_t)p[k >> 1] << 8) | p[k - 1];
+}
+
+// a * b as a full 128-bit product, low half in a and high half in b
+
+static inline void mum ( uint64_t * a, uint64_t * b )
+{
+  unsigned __int128 r = (unsigned __int128)*a * *b;
+  *a = (uint64_t)r;
+  *b = (uint64_t)(r >> 64);
+}
+
+//-----------------------------------------------------------------------------
+
+uint64_t WyHash_64 ( const void * key, int len, uint64_t seed )
+{
+  const uint8_t * p = (const uint8_t*)key;
+  uint64_t a;
+  uint64_t b;
+
+  seed ^= WyHash_mix(seed ^ secret[0],secret[1]);
+
+  if(len <= 16)
+  {
+    if(len >= 4)
+    {
+      int mid = (len >> 3) << 2;
+      a = (read32(p) << 32) | read32(p + mid);
+      b = (read32(p + len - 4) << 32) | read32(p + len - 4 - mid);
+    }
+    else if(len > 0)
+    {
+      a = read3(p,len);
+      b = 0;
+    }
+    else
+    {
+      a = b = 0;
+    }
+  }
+  else
+  {
+    int i = len;
+
+    if(i > 48)
+    {
+      uint64_t see1 = seed;
+      uint64_t see2 = seed;
+
+      do
+      {
+        seed = WyHash_mix(read64(p) ^ secret[1],read64(p + 8) ^ seed);
+        see1 = WyHash_mix(read64(p + 16) ^ secret[2],read64(p + 24) ^ see1);
+        see2 = WyHash_mix(read64(p + 32) ^ secret[3],read64(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while(i > 48);
+
+      seed ^= see1 ^ see2;
+    }
+
+    while(i > 16)
+    {
+      seed = WyHash_mix(read64(p) ^ secret[1],read64(p + 8) ^ seed);
+      p += 16;
+      i -= 16;
+    }
+
+    // last 16 bytes of the key, overlapping bytes already mixed
+    a = read64(p + i - 16);
+    b = read64(p + i - 8);
+  }
+
+  a ^= secret[1];
+  b ^= seed;
+  mum(&a,&b);
+
+  return WyHash_mix(a ^ secret[0] ^ (uint64_t)len,b ^ secret[1]);
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,25 @@
+//-----------------------------------------------------------------------------
+// wyhash-style 64-bit hash, following the structure of wyhash final v4 by
+// Wang Yi (https://github.com/wangyi-fudan/wyhash, public domain): keys are
+// folded 16 or 48 bytes at a time with 64x64->128 bit multiply-xor mixing.
+
+#ifndef _WYHASH_H_
+#define _WYHASH_H_
+
+#include <stdint.h>
+
+//-----------------------------------------------------------------------------
+
+// Multiply a by b and fold the 128-bit product to 64 bits
+
+inline uint64_t WyHash_mix ( uint64_t a, uint64_t b )
+{
+  unsigned __int128 r = (unsigned __int128)a * b;
+  return (uint64_t)r ^ (uint64_t)(r >> 64);
+}
+
+uint64_t WyHash_64 ( const void * key, int len, uint64_t seed );
+
+//-----------------------------------------------------------------------------
+
+#endif // _WYHASH_H_
@@ -0,0 +1,270 @@
+/**
+ * Filename:     XorFilter.cpp
+ *
+ * Team:         Brandon Olmos (bolmos@ucsd.edu),
+ *               Daryl Nakamoto (dnakamot@ucsd.edu)
+ *
+ * Reference(s): cplusplus.com
+ *               Graf and Lemire, Xor Filters: Faster and Smaller Than Bloom
+ *               and Cuckoo Filters (2020)
+ *               https://github.com/aappleby/smhasher/wiki/MurmurHash3
+ *
+ * Description:  Xor filter construction by hypergraph peeling. Each key
+ *               maps to one slot in each of three blocks; slots used by a
+ *               single key are peeled off repeatedly, then fingerprints are
+ *               assigned in reverse peeling order so the xor of every key's
+ *               three slots equals its fingerprint.
+ */
+
+#include "XorFilter.hpp"
+#include "MurmurHash3.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sys/stat.h>
+
+#define SEED 3
+#define XOR_FILE_VERSION 1
+#define XOR_HEADER_BYTES 64
+#define CAPACITY_FACTOR 1.23 // table slots per key needed for peeling
+#define CAPACITY_EXTRA 32    // extra slots so tiny sets still peel
+#define MAX_ATTEMPTS 100     // seeds tried before giving up
+
+using namespace std;
+
+/** Header of a saved xor filter, written in host byte order */
+struct XorHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t seed;
+    uint64_t blockLength;
+    uint64_t numItems;
+    unsigned char padding[XOR_HEADER_BYTES - 40];
+};
+
+static_assert(sizeof(XorHeader) == XOR_HEADER_BYTES, "xor header size");
+
+/** MurmurHash3 64-bit finalizer: mixes every input bit into every output bit */
+static inline uint64_t fmix64(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+static inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+/** map x onto [0, n) with a multiply instead of a modulo */
+static inline uint64_t reduce(uint64_t x, uint64_t n) {
+    return (uint64_t)(((unsigned __int128)x * n) >> 64);
+}
+
+/** 8-bit fingerprint of a seeded key hash */
+static inline uint8_t fingerprint(uint64_t hash) {
+    return (uint8_t)(hash ^ (hash >> 32));
+}
+
+/** Create an empty xor filter, reserving room for expectedItems */
+XorFilter::XorFilter(uint64_t expectedItems)
+    : blockLength(0), seed(0), numItems(0), built(false)
+{
+    keys.reserve(expectedItems);
+}
+
+/** hash an item of len bytes to its 64-bit key */
+uint64_t XorFilter::hashItem(const char* item, size_t len) {
+
+    uint64_t output[2];
+    MurmurHash3_x64_128(item, len, SEED, output);
+
+    return output[0];
+}
+
+/** the three table slots of a seeded key hash, one per block */
+void XorFilter::getSlots(uint64_t hash, uint64_t* slots) const {
+    slots[0] = reduce(hash, blockLength);
+    slots[1] = reduce(rotl64(hash, 21), blockLength) + blockLength;
+    slots[2] = reduce(rotl64(hash, 42), blockLength) + 2 * blockLength;
+}
+
+/** Insert an item of len bytes; takes effect at the build */
+void XorFilter::insert(const char* item, size_t len)
+{
+    // a built or loaded filter has no keys to rebuild from
+    if(built) return;
+
+    keys.push_back(hashItem(item, len));
+    ++numItems;
+}
+
+/** Determine whether an item of len bytes is in the filter. Never builds:
+ *  lookups may run on many threads, so build() must come first.
+ */
+bool XorFilter::find(const char* item, size_t len)
+{
+    if(!built) return false;
+
+    uint64_t hash = fmix64(hashItem(item, len) + seed);
+    uint64_t slots[3];
+    getSlots(hash, slots);
+
+    return fingerprint(hash) == (fingerprints[slots[0]] ^
+                                 fingerprints[slots[1]] ^
+                                 fingerprints[slots[2]]);
+}
+
+/** Build the table from every item inserted so far and release the keys */
+void XorFilter::build()
+{
+    if(built) return;
+
+    // peeling fails on duplicate keys
+    sort(keys.begin(), keys.end());
+    keys.erase(unique(keys.begin(), keys.end()), keys.end());
+
+    uint64_t capacity = CAPACITY_FACTOR * keys.size() + CAPACITY_EXTRA;
+    blockLength = capacity / 3;
+
+    // a fresh seed gives a fresh hypergraph; almost always one try suffices
+    for(int attempt = 0; attempt < MAX_ATTEMPTS; ++attempt) {
+        seed = fmix64(seed + attempt + 1);
+
+        built = tryBuild();
+        if(built) break;
+    }
+
+    // practically unreachable; grow the table until it peels
+    while(!built) {
+        blockLength += blockLength / 8 + 1;
+        seed = fmix64(seed + 1);
+        built = tryBuild();
+    }
+
+    // only the fingerprints are needed from here on
+    vector<uint64_t>().swap(keys);
+}
+
+/** try to build the table from keys with the current seed */
+bool XorFilter::tryBuild()
+{
+    uint64_t numSlots = 3 * blockLength;
+    vector<uint32_t> count(numSlots, 0);
+    vector<uint64_t> xorHash(numSlots, 0); // xor of the hashes in each slot
+    vector<uint64_t> queue;
+    vector<pair<uint64_t, uint64_t> > peeled; // (hash, slot) in peel order
+    uint64_t slots[3];
+
+    for(uint64_t key : keys) {
+        uint64_t hash = fmix64(key + seed);
+        getSlots(hash, slots);
+
+        for(int i = 0; i < 3; ++i) {
+            ++count[slots[i]];
+            xorHash[slots[i]] ^= hash;
+        }
+    }
+
+    // slots holding a single key can be assigned last
+    for(uint64_t slot = 0; slot < numSlots; ++slot) {
+        if(count[slot] == 1) queue.push_back(slot);
+    }
+
+    peeled.reserve(keys.size());
+    while(!queue.empty()) {
+        uint64_t slot = queue.back();
+        queue.pop_back();
+
+        if(count[slot] != 1) continue;
+
+        // the one key left in slot; remove it from all three of its slots
+        uint64_t hash = xorHash[slot];
+        peeled.push_back(make_pair(hash, slot));
+        getSlots(hash, slots);
+
+        for(int i = 0; i < 3; ++i) {
+            --count[slots[i]];
+            xorHash[slots[i]] ^= hash;
+
+            if(count[slots[i]] == 1) queue.push_back(slots[i]);
+        }
+    }
+
+    if(peeled.size() != keys.size()) return false;
+
+    // assign in reverse: each key's slot is the last of its three to be set
+    fingerprints.assign(numSlots, 0);
+    for(size_t i = peeled.size(); i-- > 0;) {
+        uint64_t hash = peeled[i].first;
+        getSlots(hash, slots);
+
+        fingerprints[peeled[i].second] = fingerprint(hash) ^
+            fingerprints[slots[0]] ^ fingerprints[slots[1]] ^
+            fingerprints[slots[2]];
+    }
+
+    return true;
+}
+
+/** Write the built table to fileName. Returns false on failure. */
+bool XorFilter::save(string fileName) const {
+
+    if(!built) return false;
+
+    XorHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, XOR_FILE_MAGIC, sizeof(header.magic));
+    header.version = XOR_FILE_VERSION;
+    header.seed = seed;
+    header.blockLength = blockLength;
+    header.numItems = numItems;
+
+    ofstream file(fileName, ios::binary | ios::trunc);
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)fingerprints.data(), fingerprints.size());
+
+    return file.good();
+}
+
+/** Read a filter written by save(). Returns nullptr if the file is missing,
+ *  truncated or incompatible.
+ */
+XorFilter* XorFilter::load(string fileName) {
+
+    struct stat info;
+    if(stat(fileName.c_str(), &info) < 0 ||
+            (uint64_t)info.st_size < sizeof(XorHeader))
+        return nullptr;
+
+    ifstream file(fileName, ios::binary);
+    XorHeader header;
+
+    // the three blocks must fit in the rest of the file, which also keeps a
+    // corrupt blockLength from overflowing the size of the fingerprint table
+    if(!file.read((char*)&header, sizeof(header)) ||
+            memcmp(header.magic, XOR_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+            header.version != XOR_FILE_VERSION || header.blockLength == 0 ||
+            header.blockLength >
+                ((uint64_t)info.st_size - sizeof(header)) / 3)
+        return nullptr;
+
+    XorFilter* filter = new XorFilter();
+    filter->fingerprints.resize(3 * header.blockLength);
+
+    if(!file.read((char*)filter->fingerprints.data(),
+                  filter->fingerprints.size())) {
+        delete filter;
+        return nullptr;
+    }
+
+    filter->seed = header.seed;
+    filter->blockLength = header.blockLength;
+    filter->numItems = header.numItems;
+    filter->built = true;
+
+    return filter;
+}
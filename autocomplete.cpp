@@ -41,7 +41,8 @@ bool findUnderscoreIn(string str)
  * cout << completion << endl;
  * cout << "Continue? (y/n)" << endl;
  *
- * arg 1 - Input file name (in format like freq_dict.txt)
+ * arg 1 - Input file name (in format like freq_dict.txt), or a frozen
+ *         image of a dictionary written by DictionaryTrie::freeze()
  *
  *
  *  Run queries for autocompletion
@@ -101,9 +102,14 @@ int main(int argc, char** argv)
     bool hasUnderscore = false;
 
     cout << "Reading file: " << file << endl;
-    load.open(file, ifstream::in);      // open file
-    read.load_dict(dictionary, load);   // populate trie
-    load.close();
+
+    // map a frozen image in place, else build the trie from text, parsed
+    // from a mapping unless the file cannot be mapped
+    if(!dictionary.loadFrozen(file) && !read.load_dict(dictionary, file)) {
+        load.open(file, ifstream::in);      // open file
+        read.load_dict(dictionary, load);   // populate trie
+        load.close();
+    }
 
 
     // start program
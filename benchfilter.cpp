@@ -0,0 +1,484 @@
+/**
+ * Filename:     benchfilter.cpp
+ *
+ * Team:         Brandon Olmos (bolmos@ucsd.edu),
+ *               Daryl Nakamoto (dnakamot@ucsd.edu)
+ *
+ * Reference(s): cplusplus.com
+ *
+ * Description:  Micro-benchmark for the bloom filter. Trains a filter on a
+ *               file of bad urls and times lookups of a file of mixed urls,
+ *               reporting lookups per second and the measured false
+ *               positive rate for each filter configuration.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cmath> // ceil()
+#include <cstdlib>
+#include "BloomFilter.hpp"
+#include "BlockedBloomFilter.hpp"
+#include "SplitBlockBloomFilter.hpp"
+#include "ConcurrentBloomFilter.hpp"
+#include "CountingBloomFilter.hpp"
+#include "XorFilter.hpp"
+#include "FixedBloomFilter.hpp"
+#include "MurmurHash3.h"
+#include <thread>
+#include "util.hpp"
+
+using namespace std;
+
+#define FACTOR 1.5
+#define MIN_ARGS 3
+#define MAX_ARGS 4
+#define NUM_RUNS 5
+#define NUM_KEYS 100000 // random keys per length in benchHashPolicy
+#define FIXED_BITS (1 << 21) // geometry of the compile time sized filter
+#define FIXED_HASHES 3
+
+/** read every line of fileName into urls */
+void readURLs(string fileName, vector<string>& urls) {
+
+    ifstream file(fileName);
+    string url;
+
+    while(getline(file, url))
+        urls.push_back(url);
+}
+
+/** train filters from make on badUrls and time lookups of mixedUrls.
+ *  Every bad url is assumed to also appear in mixedUrls.
+ */
+template<class Filter, class Make>
+void benchFilter(const char* name, Make make, vector<string>& badUrls,
+        vector<string>& mixedUrls) {
+
+    Timer timer;
+    long long insertTime = 0;
+    long long findTime = 0;
+    unsigned int numFound = 0;
+    uint64_t numBytes = 0;
+
+    for(int run = 0; run < NUM_RUNS; ++run) {
+        Filter* filter = make();
+        numBytes = filter->getNumBytes();
+
+        timer.begin_timer();
+        for(auto& url : badUrls)
+            filter->insert(url);
+        insertTime += timer.end_timer();
+
+        numFound = 0;
+        timer.begin_timer();
+        for(auto& url : mixedUrls)
+            numFound += filter->find(url);
+        findTime += timer.end_timer();
+
+        delete filter;
+    }
+
+    // nanoseconds per run to operations per second
+    double insertRate = 1e9 * NUM_RUNS * badUrls.size() / insertTime;
+    double findRate = 1e9 * NUM_RUNS * mixedUrls.size() / findTime;
+    double numSafe = mixedUrls.size() - badUrls.size();
+    double posRate = (numFound - badUrls.size()) / numSafe;
+
+    cout << name << endl;
+    cout << "  table bytes: " << numBytes << endl;
+    cout << "  inserts/sec: " << insertRate << endl;
+    cout << "  lookups/sec: " << findRate << endl;
+    cout << "  false positive rate: " << posRate << endl;
+}
+
+/** time batched lookups of mixedUrls in a BloomFilter trained on badUrls */
+void benchBatch(const char* name, uint64_t numBytes, vector<string>& badUrls,
+        vector<string>& mixedUrls) {
+
+    Timer timer;
+    long long findTime = 0;
+    bool* found = new bool[mixedUrls.size()];
+
+    BloomFilter filter(numBytes);
+    for(auto& url : badUrls)
+        filter.insert(url);
+
+    for(int run = 0; run < NUM_RUNS; ++run) {
+        timer.begin_timer();
+        filter.findBatch(mixedUrls.data(), mixedUrls.size(), found);
+        findTime += timer.end_timer();
+    }
+
+    delete[] found;
+
+    cout << name << endl;
+    cout << "  lookups/sec: "
+         << 1e9 * NUM_RUNS * mixedUrls.size() / findTime << endl;
+}
+
+/** time lookups of mixedUrls packed into one buffer and passed to the
+ *  filter as pointer/length pairs, the way a reader over a mapped file would
+ */
+void benchViews(const char* name, uint64_t numBytes, vector<string>& badUrls,
+        vector<string>& mixedUrls) {
+
+    Timer timer;
+    long long findTime = 0;
+    unsigned int numFound = 0;
+    string buffer;
+    vector<size_t> offsets;
+
+    for(auto& url : mixedUrls) {
+        offsets.push_back(buffer.size());
+        buffer += url;
+    }
+    offsets.push_back(buffer.size());
+
+    BloomFilter filter(numBytes);
+    for(auto& url : badUrls)
+        filter.insert(url);
+
+    for(int run = 0; run < NUM_RUNS; ++run) {
+        numFound = 0;
+        timer.begin_timer();
+        for(size_t i = 0; i < mixedUrls.size(); ++i)
+            numFound += filter.find(buffer.data() + offsets[i],
+                                    offsets[i + 1] - offsets[i]);
+        findTime += timer.end_timer();
+    }
+
+    cout << name << endl;
+    cout << "  lookups/sec: "
+         << 1e9 * NUM_RUNS * mixedUrls.size() / findTime << endl;
+}
+
+/** time hashing mixedUrls one at a time and four at a time, and check that
+ *  the four-lane hash matches the scalar one for every url
+ */
+void benchHash(vector<string>& mixedUrls) {
+
+    Timer timer;
+    long long scalarTime = 0;
+    long long laneTime = 0;
+    size_t numUrls = mixedUrls.size() / 4 * 4;
+    vector<uint64_t> scalar(numUrls * 2);
+    vector<uint64_t> lanes(numUrls * 2);
+
+    for(int run = 0; run < NUM_RUNS; ++run) {
+        timer.begin_timer();
+        for(size_t i = 0; i < numUrls; ++i)
+            MurmurHash3_x64_128(mixedUrls[i].data(), mixedUrls[i].size(), 3,
+                                &scalar[i * 2]);
+        scalarTime += timer.end_timer();
+
+        timer.begin_timer();
+        for(size_t i = 0; i < numUrls; i += 4) {
+            const void* keys[4];
+            int lens[4];
+
+            for(int j = 0; j < 4; ++j) {
+                keys[j] = mixedUrls[i + j].data();
+                lens[j] = mixedUrls[i + j].size();
+            }
+
+            MurmurHash3_x64_128_x4(keys, lens, 3, &lanes[i * 2]);
+        }
+        laneTime += timer.end_timer();
+    }
+
+    size_t numMismatched = 0;
+    for(size_t i = 0; i < numUrls * 2; i += 2)
+        numMismatched += scalar[i] != lanes[i] || scalar[i + 1] != lanes[i + 1];
+
+    cout << "murmur3 x64_128" << endl;
+    cout << "  scalar hashes/sec: " << 1e9 * NUM_RUNS * numUrls / scalarTime
+         << endl;
+    cout << "  4-lane hashes/sec: " << 1e9 * NUM_RUNS * numUrls / laneTime
+         << endl;
+    cout << "  mismatched hashes: " << numMismatched << " of " << numUrls
+         << endl;
+}
+
+/** time the hash policy Hash on NUM_KEYS random keys of each of a range of
+ *  lengths and on the mixed urls, then train a bloom filter probed with it
+ *  to report its false positive rate
+ */
+template<class Hash>
+void benchHashPolicy(uint64_t numBytes, vector<string>& badUrls,
+        vector<string>& mixedUrls) {
+
+    const size_t keyLens[] = { 8, 16, 32, 64, 128, 256 };
+    string name = string("hash ") + Hash::name();
+    Timer timer;
+    uint64_t output[2];
+    uint64_t sum = 0; // keeps the hashing from being optimized out
+
+    cout << name << endl;
+
+    for(size_t keyLen : keyLens) {
+        vector<string> keys(NUM_KEYS, string(keyLen, ' '));
+
+        for(auto& key : keys)
+            for(auto& c : key)
+                c = 'a' + rand() % 26;
+
+        timer.begin_timer();
+        for(int run = 0; run < NUM_RUNS; ++run) {
+            for(auto& key : keys) {
+                Hash::hash(key.data(), key.size(), run, output);
+                sum += output[0];
+            }
+        }
+        long long hashTime = timer.end_timer();
+
+        cout << "  " << keyLen << " byte keys: hashes/sec: "
+             << 1e9 * NUM_RUNS * NUM_KEYS / hashTime << endl;
+    }
+
+    timer.begin_timer();
+    for(int run = 0; run < NUM_RUNS; ++run) {
+        for(auto& url : mixedUrls) {
+            Hash::hash(url.data(), url.size(), run, output);
+            sum += output[0];
+        }
+    }
+    long long urlTime = timer.end_timer();
+
+    cout << "  mixed urls: hashes/sec: "
+         << 1e9 * NUM_RUNS * mixedUrls.size() / urlTime << endl;
+    if(sum == 1) cout << endl;
+
+    benchFilter<BasicBloomFilter<Hash>>((name + ", bloom filter").c_str(),
+            [=]() { return new BasicBloomFilter<Hash>(numBytes); },
+            badUrls, mixedUrls);
+}
+
+/** time lookups of mixedUrls in a BloomFilter of numBytes trained on
+ *  badUrls, with its table allocated as memory asks. The difference only
+ *  shows once the table is far larger than the TLB reach of normal pages.
+ */
+void benchTableMemory(const char* name, TableMemory memory, uint64_t numBytes,
+        vector<string>& badUrls, vector<string>& mixedUrls) {
+
+    Timer timer;
+    long long findTime = 0;
+    unsigned int numFound = 0;
+
+    BloomFilter filter(numBytes, DOUBLE_HASH, DEFAULT_HASHES, memory);
+    for(auto& url : badUrls)
+        filter.insert(url);
+
+    for(int run = 0; run < NUM_RUNS; ++run) {
+        timer.begin_timer();
+        for(auto& url : mixedUrls)
+            numFound += filter.find(url);
+        findTime += timer.end_timer();
+    }
+
+    cout << name << endl;
+    cout << "  huge pages: " << (filter.hasHugePages() ? "yes" : "no") << endl;
+    cout << "  lookup ns: " << (double)findTime / NUM_RUNS / mixedUrls.size()
+         << endl;
+    if(numFound == 0) cout << endl;
+}
+
+/** time training and lookups of a ConcurrentBloomFilter with 1 to
+ *  maxThreads threads, training both from badUrls in memory and from the
+ *  file badFile mapped and split between the threads
+ */
+void benchConcurrent(uint64_t numBytes, unsigned int maxThreads,
+        string badFile, vector<string>& badUrls, vector<string>& mixedUrls) {
+
+    cout << "concurrent (atomic fetch-or)" << endl;
+
+    for(unsigned int numThreads = 1; numThreads <= maxThreads; numThreads *= 2) {
+        Timer timer;
+        ConcurrentBloomFilter filter(numBytes);
+        vector<thread> workers;
+        atomic<unsigned int> numFound(0);
+        size_t perThread = (mixedUrls.size() + numThreads - 1) / numThreads;
+
+        timer.begin_timer();
+        filter.insertAll(badUrls.data(), badUrls.size(), numThreads);
+        long long insertTime = timer.end_timer();
+
+        ConcurrentBloomFilter trained(numBytes);
+        timer.begin_timer();
+        trained.trainFilter(badFile, numThreads);
+        long long trainTime = timer.end_timer();
+
+        // each thread looks up one slice of the mixed urls
+        timer.begin_timer();
+        for(unsigned int t = 0; t < numThreads; ++t) {
+            workers.push_back(thread([&, t]() {
+                size_t end = (t + 1) * perThread;
+                unsigned int found = 0;
+
+                if(end > mixedUrls.size()) end = mixedUrls.size();
+                for(size_t i = t * perThread; i < end; ++i)
+                    found += filter.find(mixedUrls[i]);
+
+                numFound += found;
+            }));
+        }
+        for(auto& worker : workers)
+            worker.join();
+        long long findTime = timer.end_timer();
+
+        cout << "  " << numThreads << " thread(s): inserts/sec: "
+             << 1e9 * badUrls.size() / insertTime << ", file lines/sec: "
+             << 1e9 * badUrls.size() / trainTime << ", lookups/sec: "
+             << 1e9 * mixedUrls.size() / findTime << endl;
+    }
+}
+
+/** time removing half of badUrls from a CountingBloomFilter, then check
+ *  that the other half is still found and how many removed urls still match
+ */
+void benchRemove(uint64_t numBytes, vector<string>& badUrls) {
+
+    Timer timer;
+    CountingBloomFilter filter(numBytes * 8);
+    size_t half = badUrls.size() / 2;
+    unsigned int numKept = 0;
+    unsigned int numStale = 0;
+
+    for(auto& url : badUrls)
+        filter.insert(url);
+
+    timer.begin_timer();
+    for(size_t i = 0; i < half; ++i)
+        filter.remove(badUrls[i]);
+    long long removeTime = timer.end_timer();
+
+    for(size_t i = 0; i < half; ++i)
+        numStale += filter.find(badUrls[i]);
+    for(size_t i = half; i < badUrls.size(); ++i)
+        numKept += filter.find(badUrls[i]);
+
+    cout << "counting (remove half of the bad urls)" << endl;
+    cout << "  removes/sec: " << 1e9 * half / removeTime << endl;
+    cout << "  kept urls still found: " << numKept << " of "
+         << badUrls.size() - half << endl;
+    cout << "  removed urls still matching: " << numStale << " of " << half
+         << endl;
+}
+
+/** build a MembershipFilter backend from badUrls and report its bits per
+ *  url, build time and lookup time on mixedUrls
+ */
+void benchBackend(const char* name, MembershipFilter* filter,
+        vector<string>& badUrls, vector<string>& mixedUrls) {
+
+    Timer timer;
+    unsigned int numFound = 0;
+
+    timer.begin_timer();
+    for(auto& url : badUrls)
+        filter->insert(url);
+    filter->build();
+    long long buildTime = timer.end_timer();
+
+    timer.begin_timer();
+    for(auto& url : mixedUrls)
+        numFound += filter->find(url);
+    long long findTime = timer.end_timer();
+
+    double numSafe = mixedUrls.size() - badUrls.size();
+
+    cout << name << endl;
+    cout << "  bits/url: " << 8.0 * filter->getNumBytes() / badUrls.size()
+         << endl;
+    cout << "  build ms: " << buildTime / 1e6 << endl;
+    cout << "  lookup ns: " << (double)findTime / mixedUrls.size() << endl;
+    cout << "  false positive rate: "
+         << (numFound - badUrls.size()) / numSafe << endl;
+
+    delete filter;
+}
+
+/**
+ * arg1 - list of malicious urls to train the filter with
+ * arg2 - list of mixed (good/bad) urls to look up
+ * arg3 - (optional) table size in bytes, FACTOR bytes per bad url if absent.
+ *        Use a size well beyond the last level cache to measure misses.
+ */
+int main(int argc, char** argv) {
+
+    if(argc < MIN_ARGS || argc > MAX_ARGS) {
+        cout << "Usage: " << argv[0] << " badUrls mixedUrls [numBytes]"
+             << endl;
+        return -1;
+    }
+
+    vector<string> badUrls;
+    vector<string> mixedUrls;
+
+    readURLs(argv[1], badUrls);
+    readURLs(argv[2], mixedUrls);
+
+    uint64_t numBytes = ceil(FACTOR * badUrls.size());
+    if(argc == MAX_ARGS)
+        numBytes = strtoull(argv[3], nullptr, 10);
+
+    benchHash(mixedUrls);
+    benchHashPolicy<Murmur3x64Hash>(numBytes, badUrls, mixedUrls);
+    benchHashPolicy<Murmur3x86Hash>(numBytes, badUrls, mixedUrls);
+    benchHashPolicy<Wy64Hash>(numBytes, badUrls, mixedUrls);
+    benchFilter<BloomFilter>("seeded probes (3 hashes)",
+            [=]() { return new BloomFilter(numBytes, SEEDED_PROBES); },
+            badUrls, mixedUrls);
+    benchFilter<BloomFilter>("double hashing (1 hash)",
+            [=]() { return new BloomFilter(numBytes, DOUBLE_HASH); },
+            badUrls, mixedUrls);
+    benchViews("double hashing, pointer/length lookups", numBytes, badUrls,
+            mixedUrls);
+    benchBatch("double hashing, batched lookups", numBytes, badUrls,
+            mixedUrls);
+    benchTableMemory("table on the heap", HEAP_TABLE, numBytes, badUrls,
+            mixedUrls);
+    benchTableMemory("table on huge pages", HUGE_PAGE_TABLE, numBytes,
+            badUrls, mixedUrls);
+    // the same geometry fixed at compile time and chosen at run time
+    benchFilter<BloomFilter>("runtime geometry (2^21 bits, 3 hashes)",
+            []() { return new BloomFilter(FIXED_BITS / 8, DOUBLE_HASH,
+                                          FIXED_HASHES); },
+            badUrls, mixedUrls);
+    benchFilter<FixedBloomFilter<FIXED_BITS, FIXED_HASHES>>(
+            "compile-time geometry (2^21 bits, 3 hashes)",
+            []() { return new FixedBloomFilter<FIXED_BITS, FIXED_HASHES>(); },
+            badUrls, mixedUrls);
+    benchFilter<BlockedBloomFilter>("cache-line blocked (1 hash)",
+            [=]() { return new BlockedBloomFilter(numBytes); },
+            badUrls, mixedUrls);
+    benchFilter<SplitBlockBloomFilter>("split block (scalar)",
+            [=]() { return new SplitBlockBloomFilter(numBytes, false); },
+            badUrls, mixedUrls);
+
+    if(SplitBlockBloomFilter::hasAVX2())
+        benchFilter<SplitBlockBloomFilter>("split block (AVX2)",
+                [=]() { return new SplitBlockBloomFilter(numBytes, true); },
+                badUrls, mixedUrls);
+    // one 4-bit counter per bit of the classic table: same false positive
+    // rate, four times the memory
+    benchFilter<CountingBloomFilter>("counting (4-bit counters)",
+            [=]() { return new CountingBloomFilter(numBytes * 8); },
+            badUrls, mixedUrls);
+    benchRemove(numBytes, badUrls);
+    // membership filter backends; the second bloom filter matches the xor
+    // filter's 1/256 false positive rate
+    benchBackend("backend: bloom", new BloomFilter(numBytes), badUrls,
+            mixedUrls);
+    benchBackend("backend: bloom at 0.39%",
+            BloomFilter::forRate(badUrls.size(), 1.0 / 256), badUrls, mixedUrls);
+    benchBackend("backend: xor", new XorFilter(badUrls.size()), badUrls,
+            mixedUrls);
+
+    unsigned int maxThreads = thread::hardware_concurrency();
+    benchConcurrent(numBytes, maxThreads ? maxThreads : 1, argv[1], badUrls,
+            mixedUrls);
+
+    return 0;
+}
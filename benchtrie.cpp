@@ -0,0 +1,231 @@
+/**
+ * Filename:     benchtrie.cpp
+ *
+ * Team:         Brandon Olmos (bolmos@ucsd.edu),
+ *               Daryl Nakamoto (dnakamot@ucsd.edu)
+ *
+ * Reference(s): cplusplus.com
+ *               man 5 proc
+ *
+ * Description:  Micro-benchmark for the dictionary trie. Loads a dictionary
+ *               file into a trie, with the istream and the mapped loader,
+ *               and reports the load time, the resident memory it took,
+ *               the node count and the time to destroy the trie again,
+ *               then times find and predictCompletions on the
+ *               dictionary's own words and their prefixes, for a trie
+ *               inserted into in file order and one bulk built from the
+ *               sorted words. Given an image
+ *               file, also freezes the trie into it and times mapping it
+ *               back and querying the mapped trie.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "DictionaryTrie.hpp"
+#include "util.hpp"
+
+using namespace std;
+
+#define MIN_ARGS 2
+#define MAX_ARGS 3
+#define NUM_RUNS 5
+#define PREFIX_LEN 3       // length of the prefixes completed
+#define PREFIX_STRIDE 16   // complete the prefix of one in this many words
+#define NUM_COMPLETIONS 10
+
+/** resident set size of this process in bytes */
+uint64_t residentBytes() {
+
+    ifstream statm("/proc/self/statm");
+    uint64_t size = 0;
+    uint64_t resident = 0;
+
+    statm >> size >> resident;
+
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+/** read the words of dictionary file fileName into words */
+void readWords(const char* fileName, vector<string>& words) {
+
+    ifstream file(fileName);
+    string line;
+
+    while(getline(file, line)) {
+        Utils::stripFrequency(line);
+        words.push_back(line);
+    }
+}
+
+/** read the (word, frequency) pairs of dictionary file fileName */
+void readEntries(const char* fileName, vector<Word>& entries) {
+
+    ifstream file(fileName);
+    string line;
+
+    while(getline(file, line)) {
+        unsigned int freq = Utils::stripFrequency(line);
+        entries.push_back(Word(line, freq));
+    }
+}
+
+/** time find on every word and predictCompletions on the prefixes of one
+ *  in PREFIX_STRIDE words
+ */
+void benchQueries(DictionaryTrie& dict, vector<string>& words) {
+
+    Timer timer;
+    long long findTime = 0;
+    long long completeTime = 0;
+    unsigned int numFound = 0;
+    unsigned int numCompleted = 0;
+    unsigned int numPrefixes = 0;
+    uint64_t numVisited = 0;
+
+    for(auto& word : words)
+        numVisited += dict.getSearchLength(word);
+
+    for(int run = 0; run < NUM_RUNS; ++run) {
+
+        numFound = 0;
+        timer.begin_timer();
+        for(auto& word : words)
+            numFound += dict.find(word);
+        findTime += timer.end_timer();
+
+        numCompleted = numPrefixes = 0;
+        timer.begin_timer();
+        for(size_t i = 0; i < words.size(); i += PREFIX_STRIDE) {
+            numCompleted += dict.predictCompletions(
+                    words[i].substr(0, PREFIX_LEN), NUM_COMPLETIONS).size();
+            ++numPrefixes;
+        }
+        completeTime += timer.end_timer();
+    }
+
+    cout << "  words found: " << numFound << " of " << words.size() << endl;
+    cout << "  nodes visited/find: " << (double)numVisited / words.size()
+         << endl;
+    cout << "  find ns: " << (double)findTime / NUM_RUNS / words.size()
+         << endl;
+    cout << "  predictCompletions us: "
+         << (double)completeTime / 1e3 / NUM_RUNS / numPrefixes
+         << " (" << numCompleted << " completions)" << endl;
+}
+
+/** time loading a fresh trie with load, and destroying it again */
+template<class Load>
+void benchLoad(const char* name, Load load, size_t numWords) {
+
+    Timer timer;
+    long long loadTime = 0;
+    long long deleteTime = 0;
+    uint64_t numNodes = 0;
+    uint64_t numBytes = 0;
+    uint64_t residentGrowth = 0;
+
+    for(int run = 0; run < NUM_RUNS; ++run) {
+
+        uint64_t residentBefore = residentBytes();
+
+        timer.begin_timer();
+        DictionaryTrie* dict = new DictionaryTrie();
+        load(*dict);
+        loadTime += timer.end_timer();
+
+        residentGrowth = residentBytes() - residentBefore;
+        numNodes = dict->getNumNodes();
+        numBytes = dict->getNumBytes();
+
+        timer.begin_timer();
+        delete dict;
+        deleteTime += timer.end_timer();
+    }
+
+    cout << name << endl;
+    cout << "  nodes: " << numNodes << endl;
+    cout << "  node bytes: " << numBytes << endl;
+    cout << "  node bytes/word: " << (double)numBytes / numWords << endl;
+    cout << "  resident growth bytes: " << residentGrowth << endl;
+    cout << "  load ms: " << loadTime / 1e6 / NUM_RUNS << endl;
+    cout << "  lines/sec: " << 1e9 * NUM_RUNS * numWords / loadTime << endl;
+    cout << "  destroy ms: " << deleteTime / 1e6 / NUM_RUNS << endl;
+}
+
+int main(int argc, char** argv) {
+
+    if(argc < MIN_ARGS || argc > MAX_ARGS) {
+        cout << "Usage: " << argv[0] << " dictionaryFile [imageFile]" << endl;
+        return -1;
+    }
+
+    vector<string> words;
+    readWords(argv[1], words);
+
+    ifstream check(argv[1]);
+    if(!check) {
+        cout << "Could not open " << argv[1] << endl;
+        return -1;
+    }
+
+    benchLoad("istream loader", [&](DictionaryTrie& dict) {
+        ifstream file(argv[1]);
+        Utils::load_dict(dict, file);
+    }, words.size());
+
+    benchLoad("mapped loader", [&](DictionaryTrie& dict) {
+        Utils::load_dict(dict, string(argv[1]));
+    }, words.size());
+
+    Timer timer;
+    DictionaryTrie dict;
+    Utils::load_dict(dict, string(argv[1]));
+    cout << "inserted in file order" << endl;
+    benchQueries(dict, words);
+
+    vector<Word> entries;
+    readEntries(argv[1], entries);
+
+    DictionaryTrie bulk;
+    timer.begin_timer();
+    bulk.build(entries);
+    long long buildTime = timer.end_timer();
+
+    cout << "bulk built" << endl;
+    cout << "  build ms: " << buildTime / 1e6 << endl;
+    benchQueries(bulk, words);
+
+    if(argc == MAX_ARGS) {
+        timer.begin_timer();
+        bool frozen = dict.freeze(argv[2]);
+        long long freezeTime = timer.end_timer();
+
+        DictionaryTrie mapped;
+        timer.begin_timer();
+        bool loaded = frozen && mapped.loadFrozen(argv[2]);
+        long long mapTime = timer.end_timer();
+
+        if(!loaded) {
+            cout << "Could not freeze into " << argv[2] << endl;
+            return -1;
+        }
+
+        // the first query pays for reading in the pages it touches
+        timer.begin_timer();
+        mapped.predictCompletions(words[0].substr(0, PREFIX_LEN),
+                NUM_COMPLETIONS);
+        long long firstTime = timer.end_timer();
+
+        cout << "frozen trie" << endl;
+        cout << "  image bytes: " << mapped.getNumBytes() << endl;
+        cout << "  freeze ms: " << freezeTime / 1e6 << endl;
+        cout << "  map ms: " << mapTime / 1e6 << endl;
+        cout << "  first query us: " << firstTime / 1e3 << endl;
+        benchQueries(mapped, words);
+    }
+
+    return 0;
+}
@@ -1,8 +1,13 @@
 #include <iostream>
 #include <fstream>
 #include "BloomFilter.hpp"
+#include "ClassifyPipeline.hpp"
+#include "ScalableBloomFilter.hpp"
+#include "XorFilter.hpp"
 #include <cmath> // ceil()
 #include <stdint.h>
+#include <cstring>
+#include <cstdlib>
 
 using namespace std;
 
@@ -13,9 +18,38 @@ using namespace std;
  * arg1 - list of malicious urls/bad words filter out
  * arg2 - list of mixed (good/bad) to only write good urls to
  * arg3 - file to write only the good urls to (one on each line)
+ *
+ * Options (may appear anywhere on the command line):
+ * -p rate - size the filter for a target false positive rate instead of
+ *           FACTOR bytes per bad url
+ * -t num  - train with num threads, each on its own slice of the bad urls
+ * -s file - save the trained filter to file
+ * -l file - load a filter saved with -s instead of training on arg1. arg1 is
+ *           then only used for the memory ratio.
+ * -w num  - classify with a pipeline of num lookup worker threads and
+ *           print the throughput of each stage
+ * -u      - with -w, write safe urls as chunks finish instead of in order
+ * -b name - filter backend:
+ *           bloom    - bloom filter (default)
+ *           xor      - xor filter for static sets, about 9.9 bits per url at
+ *                      a 0.39% false positive rate; ignores -p
+ *           scalable - grow a scalable filter while reading arg1 once,
+ *                      instead of counting the bad urls first to size the
+ *                      filter. Uses -p as its overall false positive rate,
+ *                      GROW_RATE if not given.
+ * -g      - same as -b scalable
+ * -h name - hash the bloom backend probes with:
+ *           murmur64 - MurmurHash3_x64_128 (default)
+ *           murmur32 - MurmurHash3_x86_32, cheapest on 32-bit hosts
+ *           wyhash   - wyhash-style 64-bit hash, fastest on short urls
+ * -d file - write run and filter statistics to file as JSON. Bloom filters
+ *           add their fill ratio and estimated false positive rate, and
+ *           operation counts and latency percentiles if built with
+ *           make STATS=1.
  */
 
 #define FACTOR 1.5
+#define GROW_RATE 0.01
 #define NUM_ARGS 4
 
 /** Obtain the total number of bad URLs read from the file */
@@ -56,50 +90,222 @@ double getFileSize(ifstream& file, string fileName) {
     return fileSize;
 }
 
+/** Print the false positive rate and memory saving ratio of a run */
+void printStatistics(ifstream& file, string badUrls, double numBadUrls,
+        double numUrls, double numOutput, double numBytes) {
+
+    double fileSize = getFileSize(file, badUrls);
+    double numSafeUrls = numUrls - numBadUrls;
+    double posRate = (numSafeUrls - numOutput)/numSafeUrls;
+    double memRatio = fileSize / numBytes;
+
+    cout << "False positive rate: " << posRate << endl;
+    cout << "Saved memory ratio: " << memRatio << endl;
+}
+
+/** Build a bloom filter hashed with Hash from the bad urls, sized for
+ *  targetRate if it is given. numHashes and expectedRate are set to the
+ *  filter's probe count and expected false positive rate.
+ */
+template<class Hash>
+MembershipFilter* trainBloom(ifstream& file, string badUrls,
+        double targetRate, int numThreads, unsigned int& numHashes,
+        double& expectedRate) {
+
+    double numBadUrls = getNumBadURLs(file, badUrls);
+    double numBytes;
+
+    // calculate max space for hash table
+    if(targetRate > 0)
+        numBytes = BloomFilter::optimalNumBytes(numBadUrls, targetRate);
+    else
+        numBytes = ceil(FACTOR*numBadUrls);
+
+    BasicBloomFilter<Hash>* bloom = new BasicBloomFilter<Hash>(numBytes,
+            DOUBLE_HASH, targetRate > 0
+            ? BloomFilter::optimalNumHashes(numBadUrls, numBytes)
+            : DEFAULT_HASHES);
+
+    if(numThreads > 1)
+        bloom->trainFilterParallel(badUrls, numThreads);
+    else
+        bloom->trainFilter(file, badUrls, *bloom);
+
+    numHashes = bloom->getNumHashes();
+    expectedRate = bloom->expectedFPR(bloom->getNumItems());
+
+    return bloom;
+}
+
+/** Write the statistics of a run and of its filter to statsFile as JSON */
+void dumpStatistics(string statsFile, string backend,
+        const MembershipFilter& filter, double numBadUrls, double numUrls,
+        double numOutput) {
+
+    ofstream out(statsFile);
+    double numSafeUrls = numUrls - numBadUrls;
+
+    out << "{\"backend\":\"" << backend << "\""
+        << ",\"urls\":" << numUrls
+        << ",\"safe_urls_written\":" << numOutput
+        << ",\"false_positive_rate\":"
+        << (numSafeUrls - numOutput) / numSafeUrls
+        << ",\"filter\":";
+    filter.dumpStats(out);
+    out << "}" << endl;
+
+    if(!out)
+        cout << "Could not write statistics: " << statsFile << endl;
+}
+
 // train bloom filter and classify set of unknown urls as safe or not
 int main(int argc, char** argv) {
 
+    char* args[NUM_ARGS] = { argv[0] }; // positional arguments
+    int numArgs = 1;
+    double targetRate = 0; // target false positive rate, 0 if not given
+    int numThreads = 1;    // threads used to train the filter
+    string saveFile;       // where to save the trained filter, if anywhere
+    string loadFile;       // prebuilt filter to use instead of training
+    int numWorkers = 0;    // pipeline lookup workers, 0 for no pipeline
+    bool keepOrder = true; // pipeline writes urls in input order
+    string backend = "bloom"; // which membership filter to classify with
+    string hash = "murmur64"; // which hash the bloom backend probes with
+    string statsFile;      // where to dump statistics as JSON, if anywhere
+
+    // separate options from positional arguments
+    for(int i = 1; i < argc; ++i) {
+        if(strcmp(argv[i], "-p") == 0 && i + 1 < argc)
+            targetRate = atof(argv[++i]);
+        else if(strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+            numThreads = atoi(argv[++i]);
+        else if(strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+            saveFile = argv[++i];
+        else if(strcmp(argv[i], "-l") == 0 && i + 1 < argc)
+            loadFile = argv[++i];
+        else if(strcmp(argv[i], "-w") == 0 && i + 1 < argc)
+            numWorkers = atoi(argv[++i]);
+        else if(strcmp(argv[i], "-u") == 0)
+            keepOrder = false;
+        else if(strcmp(argv[i], "-b") == 0 && i + 1 < argc)
+            backend = argv[++i];
+        else if(strcmp(argv[i], "-g") == 0)
+            backend = "scalable";
+        else if(strcmp(argv[i], "-h") == 0 && i + 1 < argc)
+            hash = argv[++i];
+        else if(strcmp(argv[i], "-d") == 0 && i + 1 < argc)
+            statsFile = argv[++i];
+        else if(numArgs < NUM_ARGS)
+            args[numArgs++] = argv[i];
+        else
+            numArgs = NUM_ARGS + 1; // too many arguments
+    }
+
     // check for correct number of aruments
-    if(argc != NUM_ARGS) {
+    if(numArgs != NUM_ARGS) {
         cout << "This program requires 3 arguments!" << endl;
         return -1;
     }
 
+    // a misspelt backend would otherwise silently run the bloom filter
+    if(backend != "bloom" && backend != "xor" && backend != "scalable") {
+        cout << "Unknown backend: " << backend
+             << " (choose bloom, xor or scalable)" << endl;
+        return -1;
+    }
+
+    if(hash != "murmur64" && hash != "murmur32" && hash != "wyhash") {
+        cout << "Unknown hash: " << hash
+             << " (choose murmur64, murmur32 or wyhash)" << endl;
+        return -1;
+    }
+
+    // the scalable filter has no file format; say so before training it
+    if(!saveFile.empty() && loadFile.empty() && backend == "scalable") {
+        cout << "The scalable backend cannot be saved (-s needs bloom or xor)"
+             << endl;
+        return -1;
+    }
+
     ifstream file;   // for reading all input files
-    ifstream check;
     ofstream output; // output file
-    string url;
-    string badUrls = argv[1];
-    string goodUrls = argv[2];
-    string outputFile = argv[3];
+    string badUrls = args[1];
+    string goodUrls = args[2];
+    string outputFile = args[3];
 
-    double posRate = 0;     // hold false positive rate
-    double memRatio = 0;    // hold memory saving ratio
     double numBadUrls = 0;  // hold number of bad URLs
-    double numSafeUrls = 0; // hold number of safe URLs
     double numUrls = 0;     // total number of URLs read
     double numOutput = 0;   // number of URLs outputted to file
     double numBytes = 0;
-    double fileSize = 0;
 
-    numBadUrls = getNumBadURLs(file, badUrls);
-    numBytes = ceil(FACTOR*numBadUrls); // calculate max space for hash table
+    MembershipFilter* filter;
+    ScalableBloomFilter* scalable = nullptr; // filter, if it is scalable
+    unsigned int numHashes = 0; // bloom filter probes, 0 if not trained here
+    double expectedRate = 0;    // bloom filter expected false positive rate
 
-
-    /** train bloom filter, classify set of unknown urls, and output "safe" one
-     *  to an output file
+    /** load a prebuilt filter, or train one on the bad urls. Classify set of
+     *  unknown urls, and output "safe" one to an output file
      */
-    BloomFilter filter(numBytes);
-    filter.trainFilter(file, badUrls, filter);
-    filter.processURLs(file, goodUrls, output, outputFile, numOutput, numUrls);
+    if(!loadFile.empty()) {
+        filter = MembershipFilter::load(loadFile);
+
+        if(!filter) {
+            cout << "Could not load filter: " << loadFile << endl;
+            return -1;
+        }
+    } else if(backend == "scalable") {
+        // grow the filter while streaming the bad urls, no counting pass
+        filter = scalable = new ScalableBloomFilter(
+                targetRate > 0 ? targetRate : GROW_RATE);
+        filter->trainFromFile(badUrls);
+    } else if(backend == "xor") {
+        filter = new XorFilter(getNumBadURLs(file, badUrls));
+        filter->trainFromFile(badUrls);
+    } else if(hash == "murmur32") {
+        filter = trainBloom<Murmur3x86Hash>(file, badUrls, targetRate,
+                numThreads, numHashes, expectedRate);
+    } else if(hash == "wyhash") {
+        filter = trainBloom<Wy64Hash>(file, badUrls, targetRate, numThreads,
+                numHashes, expectedRate);
+    } else {
+        filter = trainBloom<Murmur3x64Hash>(file, badUrls, targetRate,
+                numThreads, numHashes, expectedRate);
+    }
+
+    numBadUrls = filter->getNumItems();
+    numBytes = filter->getNumBytes();
+
+    if(!saveFile.empty() && !filter->save(saveFile))
+        cout << "Could not save filter: " << saveFile << endl;
+
+    ClassifyPipeline pipeline(*filter, numWorkers, keepOrder);
+    bool pipelined = numWorkers > 0 &&
+        pipeline.processURLs(goodUrls, output, outputFile, numOutput, numUrls);
+
+    // the pipeline needs a mappable input, otherwise classify on this thread
+    if(!pipelined)
+        filter->processURLs(file, goodUrls, output, outputFile, numOutput,
+                            numUrls);
 
     // print statistics
-    fileSize = getFileSize(file, badUrls);
-    numSafeUrls = numUrls - numBadUrls;
-    posRate = (numSafeUrls - numOutput)/numSafeUrls;
-    memRatio = fileSize / numBytes;
-    cout << "False positive rate: " << posRate << endl;
-    cout << "Saved memory ratio: " << memRatio << endl;
+    printStatistics(file, badUrls, numBadUrls, numUrls, numOutput, numBytes);
+
+    if(numHashes && targetRate > 0) {
+        cout << "Hash functions: " << numHashes << endl;
+        cout << "Expected false positive rate: " << expectedRate << endl;
+    }
+
+    if(scalable)
+        cout << "Sub-filters: " << scalable->getNumFilters() << endl;
+
+    if(pipelined)
+        pipeline.printStats(cout);
+
+    if(!statsFile.empty())
+        dumpStatistics(statsFile, loadFile.empty() ? backend : "loaded",
+                       *filter, numBadUrls, numUrls, numOutput);
+
+    delete filter;
 
     return 0;
 }
@@ -1,6 +1,7 @@
 #include <iostream>
 #include <sstream>
 #include "util.hpp"
+#include "FileIO.hpp"
 
 using std::istream;
 using std::endl;
@@ -120,6 +121,9 @@ void Utils::load_dict(DictionaryTrie& dict, istream& words)
         dict.insert(word, freq);
         word_string.clear();
     }
+
+    // lay the finished trie out for searching
+    dict.compact();
 }
 
 
@@ -158,8 +162,77 @@ void Utils::load_dict(DictionaryTrie& dict, istream& words, unsigned int num_wor
         dict.insert(word, freq);
         word_string.clear();
     }
+
+    // lay the finished trie out for searching
+    dict.compact();
 }
 
+/** Whether c separates words, as for operator>> */
+static inline bool isSpace(char c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+/*
+ * Load the words in the file fileName into the dictionary trie. One pass
+ * over the mapped file: the frequency is parsed in place and the words of
+ * the line are joined by single spaces, as the istream version does. A line
+ * already in that form is inserted straight from the mapping; only lines
+ * with extra spaces are copied, into a buffer reused for every line.
+ */
+bool Utils::load_dict(DictionaryTrie& dict, const string& fileName)
+{
+    MappedFile file;
+    if(!file.open(fileName)) return false;
+
+    const char* line;
+    size_t len;
+    string joined;
+
+    while(file.nextLine(line, len))
+    {
+        const char* end = line + len;
+        const char* c = line;
+
+        // frequency, skipping lines that do not start with one
+        while(c < end && isSpace(*c)) ++c;
+        if(c == end || *c < '0' || *c > '9') continue;
+
+        unsigned int freq = 0;
+        for(; c < end && *c >= '0' && *c <= '9'; ++c)
+            freq = freq * 10 + (*c - '0');
+
+        // words, trimmed of surrounding space
+        while(c < end && isSpace(*c)) ++c;
+        while(end > c && isSpace(end[-1])) --end;
+
+        // any space other than a single ' ' between words needs joining
+        const char* word = c;
+        bool normal = true;
+        for(const char* p = c; p < end && normal; ++p)
+            if(isSpace(*p) && (*p != ' ' || isSpace(p[1]))) normal = false;
+
+        if(normal) {
+            dict.insert(word, end - word, freq);
+            continue;
+        }
+
+        joined.clear();
+        while(c < end)
+        {
+            if(!joined.empty()) joined.push_back(' ');
+            while(c < end && !isSpace(*c)) joined.push_back(*c++);
+            while(c < end && isSpace(*c)) ++c;
+        }
+
+        dict.insert(joined.data(), joined.length(), freq);
+    }
+
+    // lay the finished trie out for searching
+    dict.compact();
+
+    return true;
+}
 
 void Utils::load_dict(vector<string>& dict, istream& words)
 {
@@ -48,6 +48,14 @@ public:
     void static load_dict(DictionaryTrie& dict, istream& words, unsigned int num_words);
 
 
+    /*
+     * Load the words in the file fileName into the dictionary, parsed in
+     * place from a memory mapping. Returns false if the file cannot be
+     * mapped (e.g. a pipe), in which case the istream version still works.
+     */
+    bool static load_dict(DictionaryTrie& dict, const string& fileName);
+
+
     void static load_dict(vector<string>& dict, istream& words);
 
 };